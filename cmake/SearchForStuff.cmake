@@ -53,7 +53,6 @@ if (EGL_API)
 endif()
 
 ## Use pcsx2 package to find module
-include(FindAio)
 ## Include cg because of zzogl-cg and zerogs
 #if(NOT GLSL_API)
 	include(FindCg)
@@ -89,10 +88,6 @@ if(Linux)
 	endif(X11_FOUND)
 endif(Linux)
 
-if(AIO_FOUND)
-    include_directories(${AIO_INCLUDE_DIR})
-endif()
-
 if(ALSA_FOUND)
 	include_directories(${ALSA_INCLUDE_DIRS})
 endif(ALSA_FOUND)
@@ -237,6 +237,12 @@ namespace HostSys
 
 	extern void Munmap( void* base, size_t size );
 
+	// Maps an entire file into memory.  Writable mappings are shared with the file, so stores
+	// go back to disk (whenever the OS gets around to it).  Returns NULL on failure, and the file
+	// length in size on success.
+	extern void* MmapFile( const wxString& filename, size_t& size, bool writable=false );
+	extern void MunmapFile( void* base, size_t size );
+
 	template< uint size >
 	void MemProtectStatic( u8 (&arr)[size], const PageProtectionMode& mode )
 	{
@@ -20,6 +20,8 @@
 #include <wx/thread.h>
 
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include <signal.h>
 #include <errno.h>
 #include <unistd.h>
@@ -212,6 +214,34 @@ void HostSys::Munmap(uptr base, size_t size)
 	munmap((void*)base, size);
 }
 
+void* HostSys::MmapFile( const wxString& filename, size_t& size, bool writable )
+{
+	int fd = open( filename.ToUTF8(), writable ? O_RDWR : O_RDONLY );
+	if (fd == -1) return NULL;
+
+	void* result = NULL;
+	struct stat st;
+
+	if ((fstat( fd, &st ) == 0) && st.st_size && (st.st_size == (size_t)st.st_size))
+	{
+		result = mmap( NULL, st.st_size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0 );
+		if (result == MAP_FAILED)
+			result = NULL;
+		else
+			size = st.st_size;
+	}
+
+	// The mapping holds its own reference to the file.
+	close( fd );
+	return result;
+}
+
+void HostSys::MunmapFile( void* base, size_t size )
+{
+	if (!base) return;
+	munmap( base, size );
+}
+
 void HostSys::MemProtect( void* baseaddr, size_t size, const PageProtectionMode& mode )
 {
 	if (!_memprotect(baseaddr, size, mode))
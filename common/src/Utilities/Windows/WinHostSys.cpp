@@ -134,6 +134,39 @@ void HostSys::Munmap(uptr base, size_t size)
 	VirtualFree((void*)base, 0, MEM_RELEASE);
 }
 
+void* HostSys::MmapFile( const wxString& filename, size_t& size, bool writable )
+{
+	HANDLE hFile = CreateFileW( filename.wc_str(), writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+		FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+
+	if (hFile == INVALID_HANDLE_VALUE) return NULL;
+
+	void* result = NULL;
+	LARGE_INTEGER length;
+
+	if (GetFileSizeEx( hFile, &length ) && length.QuadPart && !length.HighPart)
+	{
+		HANDLE hMap = CreateFileMapping( hFile, NULL, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL );
+		if (hMap)
+		{
+			result = MapViewOfFile( hMap, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0 );
+			if (result) size = length.LowPart;
+
+			// The view holds its own references to the mapping and the file.
+			CloseHandle( hMap );
+		}
+	}
+
+	CloseHandle( hFile );
+	return result;
+}
+
+void HostSys::MunmapFile( void* base, size_t size )
+{
+	if (!base) return;
+	UnmapViewOfFile( base );
+}
+
 void HostSys::MemProtect( void* baseaddr, size_t size, const PageProtectionMode& mode )
 {
 	pxAssertDev( ((size & (__pagesize-1)) == 0), pxsFmt(
@@ -4,7 +4,9 @@
 #	include <Windows.h>
 #	undef Yield
 #else
-#	include <libaio.h>
+#	include "Utilities/Threading.h"
+
+class FlatFileReaderWorker;
 #endif
 
 class AsyncFileReader
@@ -56,8 +58,42 @@ class FlatFileReader : public AsyncFileReader
 
 	bool asyncInProgress;
 #else
-	int m_fd; // FIXME don't know if overlap as an equivalent on linux
-	io_context_t m_aio_context;
+	// Reads are queued and serviced by a couple of worker threads, so several can be
+	// in flight and the EE never waits on the disk inside BeginRead.  FinishRead completes
+	// requests in the order they were begun.
+	static const uint MaxRequests = 8;
+	static const uint NumWorkers = 2;
+
+	struct ReadRequest
+	{
+		void* buffer;
+		u64 offset;
+		u32 bytes;
+		int result;
+		u8* bounce;			// aligned staging buffer (O_DIRECT only)
+		Threading::Semaphore done;
+	};
+
+	int m_fd;
+	bool m_direct;			// descriptor was opened with O_DIRECT
+	u8* m_mapping;			// whole image mapped into memory, or NULL
+	u64 m_mapsize;
+
+	ReadRequest m_requests[MaxRequests];
+	uint m_head;			// oldest request not yet finished
+	uint m_next;			// next request for a worker to pick up
+	uint m_tail;			// next free request slot
+
+	Threading::Mutex m_lock;
+	Threading::Semaphore m_pending;
+	FlatFileReaderWorker* m_workers[NumWorkers];
+	uint m_numworkers;
+	volatile bool m_quit;
+
+	friend class FlatFileReaderWorker;
+	void WorkerLoop();
+	int Service(ReadRequest& req);
+	void StopWorkers();
 #endif
 
 public:
@@ -634,7 +634,8 @@ static void mechaDecryptBytes( u32 madr, int size )
 	}
 }
 
-int cdvdReadSector() {
+// Copies one sector from src (the reader's buffer, see DoCDVDgetBufferPtr) straight into IOP memory.
+int cdvdReadSector(const u8* src) {
 	s32 bcr;
 
 	CDVD_LOG("SECTOR %d (BCR %x;%x)", cdvd.Sector, HW_DMA3_BCR_H16, HW_DMA3_BCR_L16);
@@ -706,7 +707,7 @@ int cdvdReadSector() {
 		mdest[11] = 0;
 
 		// normal 2048 bytes of sector data
-		memcpy_const(&mdest[12], cdr.Transfer, 2048);
+		memcpy_const(&mdest[12], src, 2048);
 
 		// 4 bytes of edc (not calculated at present)
 		mdest[2060] = 0;
@@ -716,7 +717,7 @@ int cdvdReadSector() {
 	}
 	else
 	{
-		memcpy_fast( mdest, cdr.Transfer, cdvd.BlockSize);
+		memcpy_fast( mdest, src, cdvd.BlockSize);
 	}
 
 	// decrypt sector's bytes
@@ -783,6 +784,8 @@ __fi void cdvdReadInterrupt()
 {
 	//Console.WriteLn("cdvdReadInterrupt %x %x %x %x %x", cpuRegs.interrupt, cdvd.Readed, cdvd.Reading, cdvd.nSectors, (HW_DMA3_BCR_H16 * HW_DMA3_BCR_L16) *4);
 
+	const u8* sector = cdr.Transfer;
+
 	cdvd.Ready = CDVD_NOTREADY;
 	if (!cdvd.Readed)
 	{
@@ -811,7 +814,7 @@ __fi void cdvdReadInterrupt()
 	{
 		if( cdvd.RErr == 0 )
 		{
-			while( (cdvd.RErr = DoCDVDgetBuffer(cdr.Transfer)), cdvd.RErr == -2 )
+			while( (cdvd.RErr = DoCDVDgetBufferPtr(&sector, cdr.Transfer)), cdvd.RErr == -2 )
 			{
 				// not finished yet ... block on the read until it finishes.
 				Threading::Sleep( 0 );
@@ -844,7 +847,7 @@ __fi void cdvdReadInterrupt()
 
 	if (cdvd.nSectors > 0)
 	{
-		if (cdvdReadSector() == -1)
+		if (cdvdReadSector(sector) == -1)
 		{
 			// This means that the BCR/DMA hasn't finished yet, and rather than fire off the
 			// sector-finished notice too early (which might overwrite game data) we delay a
@@ -465,6 +465,32 @@ s32 DoCDVDgetBuffer(u8* buffer)
 	return ret;
 }
 
+// Fetches the sector from the last readTrack without copying it, when the source allows:
+// the internal iso reader can hand out a pointer into its own read buffer.  Anything else
+// (plugins, or sectors needing a synthesized header) is copied into scratch, and *buffer
+// points there instead.
+s32 DoCDVDgetBufferPtr(const u8** buffer, u8* scratch)
+{
+	CheckNullCDVD();
+	int ret = 1;
+
+	if (CDVD == &CDVDapi_Iso)
+		ret = ISOgetBufferPtr(buffer);
+
+	if (ret > 0)
+	{
+		ret = CDVD->getBuffer2(scratch);
+		*buffer = scratch;
+	}
+
+	if (ret == 0 && blockDumpFile.IsOpened())
+	{
+		blockDumpFile.WriteSector(*buffer, lastLSN);
+	}
+
+	return ret;
+}
+
 s32 DoCDVDdetectDiskType()
 {
 	CheckNullCDVD();
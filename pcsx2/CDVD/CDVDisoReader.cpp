@@ -446,6 +446,13 @@ s32 CALLBACK ISOgetBuffer2(u8* buffer)
 	return iso.FinishRead3(buffer, pmode);
 }
 
+// Not part of the plugin API; lets the core DMA sectors straight out of the iso reader's
+// buffer.  Returns 1 when the sector has to be fetched through ISOgetBuffer2 instead.
+s32 ISOgetBufferPtr(const u8** buffer)
+{
+	return iso.FinishRead3Ptr(buffer, pmode);
+}
+
 //u8* CALLBACK ISOgetBuffer()
 //{
 //	iso.FinishRead();
@@ -21,4 +21,6 @@
 #include "IopCommon.h"
 #include "IsoFileFormats.h"
 
+extern s32 ISOgetBufferPtr(const u8** buffer);
+
 #endif
@@ -88,6 +88,30 @@ void InputIsoFile::BeginRead2(uint lsn)
 	m_read_inprogress = true;
 }
 
+// Where the data for each read mode sits within a raw 2352 byte sector.
+static void GetModeWindow(uint mode, int& offset, int& length)
+{
+	switch (mode)
+	{
+	case CDVD_MODE_2352:
+		offset = 0;
+		length = 2352;
+		break;
+	case CDVD_MODE_2340:
+		offset = 12;
+		length = 2340;
+		break;
+	case CDVD_MODE_2328:
+		offset = 24;
+		length = 2328;
+		break;
+	case CDVD_MODE_2048:
+		offset = 24;
+		length = 2048;
+		break;
+	}
+}
+
 int InputIsoFile::FinishRead3(u8* dst, uint mode)
 {
 	int _offset, length;
@@ -105,25 +129,7 @@ int InputIsoFile::FinishRead3(u8* dst, uint mode)
 			return ret;
 	}
 		
-	switch (mode)
-	{
-	case CDVD_MODE_2352:
-		_offset = 0;
-		length = 2352;
-		break;
-	case CDVD_MODE_2340:
-		_offset = 12;
-		length = 2340;
-		break;
-	case CDVD_MODE_2328:
-		_offset = 24;
-		length = 2328;
-		break;
-	case CDVD_MODE_2048:
-		_offset = 24;
-		length = 2048;
-		break;
-	}
+	GetModeWindow(mode, _offset, length);
 
 	int end1 = m_blockofs + m_blocksize;
 	int end2 = _offset + length;
@@ -156,6 +162,38 @@ int InputIsoFile::FinishRead3(u8* dst, uint mode)
 	return 0;
 }
 
+// Like FinishRead3, but points dst straight at the sector in the read buffer instead of copying
+// it.  That's only possible when the image stores everything the mode asks for, ie. there's no
+// header to synthesize; otherwise returns 1 and the caller should use FinishRead3.  The pointer
+// is valid until the next BeginRead2.
+int InputIsoFile::FinishRead3Ptr(const u8** dst, uint mode)
+{
+	int _offset, length;
+	int ret = 0;
+
+	if(m_current_lsn < 0)
+		return -1;
+
+	if(m_read_inprogress)
+	{
+		ret = m_reader->FinishRead();
+		m_read_inprogress = false;
+
+		if(ret < 0)
+			return ret;
+	}
+
+	GetModeWindow(mode, _offset, length);
+
+	if(_offset < m_blockofs || _offset + length > m_blockofs + (int)m_blocksize)
+		return 1;
+
+	uint read_offset = (m_current_lsn - m_read_lsn) * m_blocksize;
+	*dst = m_readbuffer + read_offset + (_offset - m_blockofs);
+
+	return 0;
+}
+
 InputIsoFile::InputIsoFile()
 {
 	_init();
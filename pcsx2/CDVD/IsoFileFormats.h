@@ -88,6 +88,7 @@ public:
 
 	void BeginRead2(uint lsn);
 	int FinishRead3(u8* dest, uint mode);
+	int FinishRead3Ptr(const u8** dest, uint mode);
 	
 protected:
 	void _init();
@@ -20,11 +20,6 @@
 #include "vtlb.h"
 _cacheS pCache[64];
 
-#define DIRTY_FLAG 0x40
-#define VALID_FLAG 0x20
-#define LRF_FLAG 0x10
-#define LOCK_FLAG 0x8
-
 using namespace R5900;
 using namespace vtlb_private;
 
@@ -236,6 +231,23 @@ u64 readCache64(u32 mem) {
 	return pCache[i].data[number][(mem >> 4) & 0x3].b8._u64[(mem&0xf)>>3];
 }
 
+mem8_t  __fastcall vtlb_CacheRead8  (u32 mem) { return readCache8(mem); }
+mem16_t __fastcall vtlb_CacheRead16 (u32 mem) { return readCache16(mem); }
+mem32_t __fastcall vtlb_CacheRead32 (u32 mem) { return readCache32(mem); }
+void    __fastcall vtlb_CacheRead64 (u32 mem, mem64_t* out) { *out = readCache64(mem); }
+
+void __fastcall vtlb_CacheRead128(u32 mem, mem128_t* out)
+{
+	out->lo = readCache64(mem);
+	out->hi = readCache64(mem+8);
+}
+
+void __fastcall vtlb_CacheWrite8  (u32 mem, mem8_t value)  { writeCache8(mem, value); }
+void __fastcall vtlb_CacheWrite16 (u32 mem, mem16_t value) { writeCache16(mem, value); }
+void __fastcall vtlb_CacheWrite32 (u32 mem, mem32_t value) { writeCache32(mem, value); }
+void __fastcall vtlb_CacheWrite64 (u32 mem, const mem64_t* value)  { writeCache64(mem, *value); }
+void __fastcall vtlb_CacheWrite128(u32 mem, const mem128_t* value) { writeCache128(mem, value); }
+
 namespace R5900 {
 namespace Interpreter
 {
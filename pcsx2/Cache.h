@@ -18,6 +18,10 @@
 
 #include "Common.h"
 
+#define DIRTY_FLAG 0x40
+#define VALID_FLAG 0x20
+#define LRF_FLAG 0x10
+#define LOCK_FLAG 0x8
 
 union _u8bit_128
 {
@@ -49,4 +53,16 @@ u16 readCache16(u32 mem);
 u32 readCache32(u32 mem);
 u64 readCache64(u32 mem);
 
+// vtlb-style handlers for recompiled loads/stores that miss the inline tag check.
+mem8_t  __fastcall vtlb_CacheRead8  (u32 mem);
+mem16_t __fastcall vtlb_CacheRead16 (u32 mem);
+mem32_t __fastcall vtlb_CacheRead32 (u32 mem);
+void    __fastcall vtlb_CacheRead64 (u32 mem, mem64_t* out);
+void    __fastcall vtlb_CacheRead128(u32 mem, mem128_t* out);
+void    __fastcall vtlb_CacheWrite8  (u32 mem, mem8_t value);
+void    __fastcall vtlb_CacheWrite16 (u32 mem, mem16_t value);
+void    __fastcall vtlb_CacheWrite32 (u32 mem, mem32_t value);
+void    __fastcall vtlb_CacheWrite64 (u32 mem, const mem64_t* value);
+void    __fastcall vtlb_CacheWrite128(u32 mem, const mem128_t* value);
+
 #endif /* __CACHE_H__ */
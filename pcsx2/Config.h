@@ -137,19 +137,25 @@ struct TraceLogFilters
 	// so I prefer this to help keep them usable.
 	bool	Enabled;
 
+	// Binary - write fixed size binary records to emuLog.trace instead of formatted text to
+	// emuLog.txt.  Formatting is deferred to tools/tracefmt, which keeps heavy DMA/VIF/IOP
+	// tracing from slowing emulation to a crawl.
+	bool	Binary;
+
 	TraceFiltersEE	EE;
 	TraceFiltersIOP	IOP;
 
 	TraceLogFilters()
 	{
 		Enabled	= false;
+		Binary	= false;
 	}
 
 	void LoadSave( IniInterface& ini );
 
 	bool operator ==( const TraceLogFilters& right ) const
 	{
-		return OpEqu( Enabled ) && OpEqu( EE ) && OpEqu( IOP );
+		return OpEqu( Enabled ) && OpEqu( Binary ) && OpEqu( EE ) && OpEqu( IOP );
 	}
 
 	bool operator !=( const TraceLogFilters& right ) const
@@ -178,10 +184,11 @@ struct Pcsx2Config
 		BITFIELD32()
 			bool
 				Enabled:1,			// universal toggle for the profiler.
-				RecBlocks_EE:1,		// Enables per-block profiling for the EE recompiler [unimplemented]
-				RecBlocks_IOP:1,	// Enables per-block profiling for the IOP recompiler [unimplemented]
-				RecBlocks_VU0:1,	// Enables per-block profiling for the VU0 recompiler [unimplemented]
-				RecBlocks_VU1:1;	// Enables per-block profiling for the VU1 recompiler [unimplemented]
+				RecBlocks_EE:1,		// Enables per-block profiling for the EE recompiler [Linux perf map only]
+				RecBlocks_IOP:1,	// Enables per-block profiling for the IOP recompiler [Linux perf map only]
+				RecBlocks_VU0:1,	// Enables per-block profiling for the VU0 recompiler [Linux perf map only]
+				RecBlocks_VU1:1,	// Enables per-block profiling for the VU1 recompiler [Linux perf map only]
+				GuestSamples:1;		// Samples guest PCs and writes a hot-spot report per game
 		BITFIELD_END
 
 		// Default is Disabled, with all recs enabled underneath.
@@ -230,6 +237,8 @@ struct Pcsx2Config
 				PreBlockCheckIOP:1;
 			bool
 				EnableEECache   :1;
+			bool
+				EnableFastmem	:1;
 		BITFIELD_END
 
 		RecompilerOptions();
@@ -383,11 +392,14 @@ struct Pcsx2Config
 				IntcStat		:1,		// tells Pcsx2 to fast-forward through intc_stat waits.
 				WaitLoop		:1,		// enables constant loop detection and fast-forwarding
 				vuFlagHack		:1,		// microVU specific flag hack
-				vuThread        :1;		// Enable Threaded VU1
+				vuThread        :1,		// Enable Threaded VU1
+				iopThread       :1,		// Run the IOP on its own thread (experimental)
+				vuOptTier		:1;		// Recompile hot microVU programs with extra optimizations (GameDB: mvuOptTier)
 		BITFIELD_END
 
 		u8	EECycleRate;		// EE cycle rate selector (1.0, 1.5, 2.0)
 		u8	VUCycleSteal;		// VU Cycle Stealer factor (0, 1, 2, or 3)
+		uint IopThreadSlack;	// EE cycles allowed between IOP thread syncs
 
 		SpeedhackOptions();
 		void LoadSave( IniInterface& conf );
@@ -395,7 +407,7 @@ struct Pcsx2Config
 
 		bool operator ==( const SpeedhackOptions& right ) const
 		{
-			return OpEqu( bitset ) && OpEqu( EECycleRate ) && OpEqu( VUCycleSteal );
+			return OpEqu( bitset ) && OpEqu( EECycleRate ) && OpEqu( VUCycleSteal ) && OpEqu( IopThreadSlack );
 		}
 
 		bool operator !=( const SpeedhackOptions& right ) const
@@ -408,14 +420,20 @@ struct Pcsx2Config
 		bool
 			CdvdVerboseReads	:1,		// enables cdvd read activity verbosely dumped to the console
 			CdvdDumpBlocks		:1,		// enables cdvd block dumping
+			CdvdDirectReads		:1,		// reads ISO images with O_DIRECT, bypassing the OS file cache (Linux)
+			CdvdMappedReads		:1,		// maps ISO images into memory when they fit in the address space (Linux)
 			EnablePatches		:1,		// enables patch detection and application
 			EnableCheats		:1,		// enables cheat detection and application
 
 		// when enabled uses BOOT2 injection, skipping sony bios splashes
 			UseBOOT2Injection	:1,
+		// caches the VM state reached by a BOOT2 injection boot, and restores it on later boots
+			BootSnapshots		:1,
 			BackupSavestate		:1,
 		// enables simulated ejection of memory cards when loading savestates
 			McdEnableEjection	:1,
+		// serves memory card accesses from memory, writing changes back on a background thread
+			McdBufferedWrites	:1,
 
 			MultitapPort0_Enabled:1,
 			MultitapPort1_Enabled:1,
@@ -478,6 +496,7 @@ TraceLogFilters&				SetTraceConfig();
 // ------------ CPU / Recompiler Options ---------------
 
 #define THREAD_VU1					(EmuConfig.Cpu.Recompiler.UseMicroVU1 && EmuConfig.Speedhacks.vuThread)
+#define THREAD_IOP					(EmuConfig.Speedhacks.iopThread)
 #define CHECK_MICROVU0				(EmuConfig.Cpu.Recompiler.UseMicroVU0)
 #define CHECK_MICROVU1				(EmuConfig.Cpu.Recompiler.UseMicroVU1)
 #define CHECK_EEREC					(EmuConfig.Cpu.Recompiler.EnableEE && GetCpuProviders().IsRecAvailable_EE())
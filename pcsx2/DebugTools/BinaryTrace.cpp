@@ -0,0 +1,420 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2010  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// --------------------------------------------------------------------------------------
+//  Binary Trace Logging
+// --------------------------------------------------------------------------------------
+// Formatting every trace record with vsnprintf on the emulation threads (and writing it
+// out as text) makes heavy DMA/VIF/IOP tracing painfully slow.  In binary mode a trace
+// call instead copies its raw printf arguments into a record in a ring buffer owned by the
+// calling thread (arguments that don't fit in one slot spill into the slots after it).
+// Each ring has a single producer (its thread) and a single consumer (the writer
+// thread), so no locks are needed on the logging path.  The writer drains all rings every
+// few milliseconds into emuLog.trace, and tools/tracefmt turns the file back into the
+// usual emuLog text.
+//
+// If a ring fills up faster than the writer can drain it, records are dropped (and
+// counted) rather than stalling emulation.
+
+#include "PrecompiledHeader.h"
+#include "Debug.h"
+#include "BinaryTraceFormat.h"
+
+#include "Utilities/PersistentThread.h"
+
+#include <wx/filename.h>
+#include <map>
+
+using namespace Threading;
+
+// A record takes one slot, plus one per BinaryTrace_PayloadSize bytes of payload beyond the
+// first.  Only the payload of those extra slots is used.
+struct BinaryTraceRingEntry
+{
+	const SysTraceLog*	source;
+	const char*			fmt;
+	u32					flags;
+	u32					pc;
+	u32					cycle;
+	u32					length;		// payload bytes held in the following slots
+	u8					payload[BinaryTrace_PayloadSize];
+};
+
+struct BinaryTraceRing
+{
+	static const uint Size = 0x4000;		// must be a power of two
+
+	BinaryTraceRing*		next;
+
+	__aligned(64) volatile u32	head;		// written by the writer thread only
+	__aligned(64) volatile u32	tail;		// written by the owning thread only
+	volatile u32				dropped;
+
+	BinaryTraceRingEntry	entries[Size];
+};
+
+// --------------------------------------------------------------------------------------
+//  BinaryTraceWriter
+// --------------------------------------------------------------------------------------
+class BinaryTraceWriter : public pxThread
+{
+	typedef pxThread _parent;
+
+protected:
+	Mutex						m_lock;			// guards m_rings and m_file
+	BinaryTraceRing*			m_rings;
+	FILE*						m_file;
+	volatile bool				m_quit;
+	Semaphore					m_wake;
+
+	std::map<const void*, u32>	m_formats;
+	std::map<const void*, u32>	m_sources;
+
+public:
+	BinaryTraceWriter()
+		: pxThread( L"BinaryTraceWriter" )
+	{
+		m_rings	= NULL;
+		m_file	= NULL;
+		m_quit	= false;
+	}
+
+	virtual ~BinaryTraceWriter() throw()
+	{
+		Close();
+	}
+
+	BinaryTraceRing* Register();
+	void Close();
+
+protected:
+	void ExecuteTaskInThread();
+
+	bool OpenFile();
+	void Drain();
+	void WriteEntry( u16 tag, u32 flags, u32 id, const char* text, uint length );
+	u32 GetFormatId( const char* fmt );
+	u32 GetSourceId( const SysTraceLog* source );
+};
+
+static BinaryTraceWriter			s_TraceWriter;
+static __threadlocal BinaryTraceRing*	tls_TraceRing = NULL;
+
+BinaryTraceRing* BinaryTraceWriter::Register()
+{
+	BinaryTraceRing* ring = (BinaryTraceRing*)_aligned_malloc( sizeof(BinaryTraceRing), 64 );
+	if( !ring ) return NULL;
+
+	ring->head		= 0;
+	ring->tail		= 0;
+	ring->dropped	= 0;
+
+	ScopedLock lock( m_lock );
+	ring->next	= m_rings;
+	m_rings		= ring;
+
+	if( !IsRunning() )
+	{
+		m_quit = false;
+		Start();
+	}
+
+	return ring;
+}
+
+void BinaryTraceWriter::Close()
+{
+	if( IsRunning() )
+	{
+		m_quit = true;
+		m_wake.Post();
+		Block();
+	}
+
+	// Pick up anything queued after the writer's last pass.  Rings are left allocated,
+	// since their threads still hold pointers to them.
+	Drain();
+
+	ScopedLock lock( m_lock );
+	if( m_file )
+	{
+		fclose( m_file );
+		m_file = NULL;
+	}
+
+	m_formats.clear();
+	m_sources.clear();
+}
+
+void BinaryTraceWriter::ExecuteTaskInThread()
+{
+	while( !m_quit )
+	{
+		m_wake.WaitWithoutYield( wxTimeSpan( 0, 0, 0, 5 ) );
+		Drain();
+	}
+}
+
+bool BinaryTraceWriter::OpenFile()
+{
+	if( m_file ) return true;
+
+	wxFileName filename( emuLogName.IsEmpty() ? wxString(L"emuLog.txt") : emuLogName );
+	filename.SetExt( L"trace" );
+
+	m_file = fopen( filename.GetFullPath().ToUTF8(), "wb" );
+	if( !m_file )
+	{
+		Console.Error( L"BinaryTrace: could not create %s", filename.GetFullPath().c_str() );
+		return false;
+	}
+
+	BinaryTraceFileHeader header;
+	header.magic	= BinaryTrace_Magic;
+	header.version	= BinaryTrace_Version;
+	header.longsize	= sizeof(long);
+	header.reserved	= 0;
+	fwrite( &header, sizeof(header), 1, m_file );
+
+	m_formats.clear();
+	m_sources.clear();
+	return true;
+}
+
+void BinaryTraceWriter::WriteEntry( u16 tag, u32 flags, u32 id, const char* text, uint length )
+{
+	BinaryTraceEntry entry;
+	memzero( entry );
+	entry.tag		= tag;
+	entry.length	= length;
+	entry.flags		= flags;
+	entry.source	= id;
+	entry.format	= id;
+
+	fwrite( &entry, sizeof(entry), 1, m_file );
+	if( length ) fwrite( text, length, 1, m_file );
+}
+
+u32 BinaryTraceWriter::GetFormatId( const char* fmt )
+{
+	std::map<const void*, u32>::iterator it = m_formats.find( fmt );
+	if( it != m_formats.end() ) return it->second;
+
+	u32 id = m_formats.size();
+	m_formats[fmt] = id;
+
+	WriteEntry( BTT_Format, 0, id, fmt, std::min<uint>( strlen(fmt), 0xffff ) );
+	return id;
+}
+
+u32 BinaryTraceWriter::GetSourceId( const SysTraceLog* source )
+{
+	std::map<const void*, u32>::iterator it = m_sources.find( source );
+	if( it != m_sources.end() ) return it->second;
+
+	u32 id = m_sources.size();
+	m_sources[source] = id;
+
+	const char* name	= "";
+	const char* suffix	= "";
+	u32 flags = source->GetTracePrefix( name, suffix ) ? BTF_HasPrefix : 0;
+
+	// "name\0suffix"
+	char text[128];
+	uint namelen	= std::min<uint>( strlen(name), 63 );
+	uint suffixlen	= std::min<uint>( strlen(suffix), 63 );
+	memcpy( text, name, namelen );
+	text[namelen] = 0;
+	memcpy( text + namelen + 1, suffix, suffixlen );
+
+	WriteEntry( BTT_Source, flags, id, text, namelen + 1 + suffixlen );
+	return id;
+}
+
+void BinaryTraceWriter::Drain()
+{
+	ScopedLock lock( m_lock );
+
+	bool wrote = false;
+
+	for( BinaryTraceRing* ring = m_rings; ring; ring = ring->next )
+	{
+		u32 head = ring->head;
+		u32 tail = AtomicRead( ring->tail );
+		u32 dropped = AtomicExchange( ring->dropped, 0 );
+
+		if( head == tail && !dropped ) continue;
+		if( !OpenFile() )
+		{
+			// Nowhere to put them; just keep the rings from filling up.
+			AtomicExchange( ring->head, tail );
+			continue;
+		}
+
+		while( head != tail )
+		{
+			const BinaryTraceRingEntry& src = ring->entries[head++ & (BinaryTraceRing::Size-1)];
+
+			BinaryTraceEntry entry;
+			entry.tag		= BTT_Record;
+			entry.length	= src.length;
+			entry.flags		= src.flags;
+			entry.pc		= src.pc;
+			entry.cycle		= src.cycle;
+			entry.source	= GetSourceId( src.source );
+			entry.format	= GetFormatId( src.fmt );
+			memcpy( entry.payload, src.payload, sizeof(entry.payload) );
+
+			fwrite( &entry, sizeof(entry), 1, m_file );
+
+			for( uint remaining = src.length; remaining; )
+			{
+				const BinaryTraceRingEntry& extra = ring->entries[head++ & (BinaryTraceRing::Size-1)];
+				uint length = std::min( remaining, BinaryTrace_PayloadSize );
+				fwrite( extra.payload, length, 1, m_file );
+				remaining -= length;
+			}
+		}
+
+		// Release the slots only after they've been copied out.
+		AtomicExchange( ring->head, tail );
+
+		if( dropped ) WriteEntry( BTT_Dropped, dropped, 0, NULL, 0 );
+		wrote = true;
+	}
+
+	if( wrote ) fflush( m_file );
+}
+
+// --------------------------------------------------------------------------------------
+//  Record encoding
+// --------------------------------------------------------------------------------------
+// Packs the arguments consumed by fmt into the payload, in the layout described in
+// BinaryTraceFormat.h, and advances pos past them.  Returns false if they didn't all fit.
+static bool EncodeArgs( u8*& pos, u8* const end, const char* fmt, va_list list )
+{
+	BinaryTraceArg arg;
+	while( (fmt = BinaryTrace_ParseFormat( fmt, arg, sizeof(long) )) != NULL )
+	{
+		for( int i=0; i<arg.stars; ++i )
+		{
+			if( pos + 4 > end ) return false;
+			s32 value = va_arg( list, int );
+			memcpy( pos, &value, 4 );
+			pos += 4;
+		}
+
+		switch( arg.type )
+		{
+			case BTA_Int:
+			{
+				if( pos + arg.size > end ) return false;
+				if( arg.size == 4 )
+				{
+					u32 value = va_arg( list, unsigned int );
+					memcpy( pos, &value, 4 );
+				}
+				else
+				{
+					u64 value = (arg.longs == 1) ? (u64)va_arg( list, unsigned long ) : va_arg( list, u64 );
+					memcpy( pos, &value, 8 );
+				}
+				pos += arg.size;
+			}
+			break;
+
+			case BTA_Double:
+			{
+				if( pos + 8 > end ) return false;
+				double value = va_arg( list, double );
+				memcpy( pos, &value, 8 );
+				pos += 8;
+			}
+			break;
+
+			case BTA_Pointer:
+			{
+				if( pos + 8 > end ) return false;
+				u64 value = (uptr)va_arg( list, void* );
+				memcpy( pos, &value, 8 );
+				pos += 8;
+			}
+			break;
+
+			case BTA_String:
+			{
+				const char* str = va_arg( list, const char* );
+				if( !str ) str = "(null)";
+
+				while( *str && pos < end - 1 ) *pos++ = *str++;
+				if( pos >= end ) return false;
+				*pos++ = 0;
+				if( *str ) return false;
+			}
+			break;
+		}
+	}
+
+	return true;
+}
+
+void BinaryTrace_WriteV( const SysTraceLog& source, const char* fmt, va_list list )
+{
+	BinaryTraceRing* ring = tls_TraceRing;
+	if( !ring )
+	{
+		ring = tls_TraceRing = s_TraceWriter.Register();
+		if( !ring ) return;
+	}
+
+	u8 payload[BinaryTrace_MaxPayloadSize];
+	u8* end = payload;
+	bool complete = EncodeArgs( end, payload + BinaryTrace_MaxPayloadSize, fmt, list );
+
+	uint length = end - payload;
+	uint extra = (length > BinaryTrace_PayloadSize) ? length - BinaryTrace_PayloadSize : 0;
+	uint slots = 1 + (extra + BinaryTrace_PayloadSize - 1) / BinaryTrace_PayloadSize;
+
+	u32 tail = ring->tail;
+	if( tail - AtomicRead( ring->head ) > BinaryTraceRing::Size - slots )
+	{
+		AtomicIncrement( ring->dropped );
+		return;
+	}
+
+	BinaryTraceRingEntry& entry = ring->entries[tail & (BinaryTraceRing::Size-1)];
+	entry.source	= &source;
+	entry.fmt		= fmt;
+	source.GetTraceContext( entry.pc, entry.cycle );
+	entry.flags		= complete ? 0 : BTF_Truncated;
+	entry.length	= extra;
+	memcpy( entry.payload, payload, std::min( length, BinaryTrace_PayloadSize ) );
+
+	for( uint i = 1; i < slots; ++i )
+	{
+		const uint offset = i * BinaryTrace_PayloadSize;
+		memcpy( ring->entries[(tail + i) & (BinaryTraceRing::Size-1)].payload, payload + offset, std::min( length - offset, BinaryTrace_PayloadSize ) );
+	}
+
+	// Publishes the record to the writer (full barrier).
+	AtomicExchange( ring->tail, tail + slots );
+}
+
+// Flushes and closes emuLog.trace.  Called during shutdown, after the emulation threads
+// have stopped.
+void BinaryTrace_Close()
+{
+	s_TraceWriter.Close();
+}
@@ -0,0 +1,167 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2010  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// --------------------------------------------------------------------------------------
+//  Binary trace file format  (emuLog.trace)
+// --------------------------------------------------------------------------------------
+// Shared by the emulator (DebugTools/BinaryTrace.cpp) and the offline formatter
+// (tools/tracefmt), so this header must not depend on anything beyond Pcsx2Types.h.
+//
+// The file is a BinaryTraceFileHeader followed by a stream of BinaryTraceEntry records,
+// each followed by 'length' bytes of extra data.  For Format and Source entries that's
+// their text.  Record entries hold the raw printf arguments of one trace log call; the
+// first BinaryTrace_PayloadSize bytes are stored in the entry and the rest, up to
+// BinaryTrace_MaxPayloadSize in all, follow it.  Arguments are packed in the order the
+// format string consumes them:
+//   * integers are 4 bytes, or 8 for %ll (and %l, if the emulator's long is 8 bytes)
+//   * doubles and pointers are 8 bytes
+//   * strings are copied inline, NUL terminated
+// Records are written in per-thread batches, so entries from different threads (EE, IOP,
+// MTVU) are only ordered within each thread.
+
+static const u32 BinaryTrace_Magic		= 0x43525450;	// "PTRC"
+static const u32 BinaryTrace_Version	= 2;	// 2: records may carry extra payload
+
+struct BinaryTraceFileHeader
+{
+	u32		magic;
+	u32		version;
+	u32		longsize;		// sizeof(long) in the emulator that wrote the file
+	u32		reserved;
+};
+
+enum BinaryTraceTag
+{
+	BTT_Record = 1,		// one log call
+	BTT_Format,			// defines format id 'format'; text is the printf format string
+	BTT_Source,			// defines source id 'source'; text is "prefix\0suffix"
+	BTT_Dropped,		// 'flags' records were dropped because a thread's ring buffer was full
+};
+
+enum BinaryTraceFlags
+{
+	// Record: the arguments didn't all fit in BinaryTrace_MaxPayloadSize bytes.
+	BTF_Truncated		= 1,
+
+	// Source: lines get the standard "%-4s(%8.8x %8.8x): " prefix with pc and cycle.
+	BTF_HasPrefix		= 1,
+};
+
+static const uint BinaryTrace_PayloadSize		= 40;
+
+// Large enough for the hardware register logs, which pass 128 bit values and register
+// names as strings.
+static const uint BinaryTrace_MaxPayloadSize	= 240;
+
+struct BinaryTraceEntry
+{
+	u16		tag;
+	u16		length;
+	u32		flags;
+	u32		pc;
+	u32		cycle;
+	u32		source;
+	u32		format;
+	u8		payload[BinaryTrace_PayloadSize];
+};
+
+enum BinaryTraceArgType
+{
+	BTA_Int,
+	BTA_Double,
+	BTA_String,
+	BTA_Pointer,
+};
+
+struct BinaryTraceArg
+{
+	BinaryTraceArgType	type;
+	int					size;		// BTA_Int only: 4 or 8
+	int					longs;		// number of 'l' length modifiers
+	int					stars;		// '*' width/precision arguments preceding this one (4 bytes each)
+	const char*			spec;		// from the '%' through to the conversion character
+	int					speclen;
+};
+
+// Finds the next argument-consuming conversion in a printf format string.  Returns a pointer
+// past it, or NULL when the string has no more conversions.
+static const char* BinaryTrace_ParseFormat( const char* fmt, BinaryTraceArg& arg, int longsize )
+{
+	while( *fmt )
+	{
+		if( *fmt++ != '%' ) continue;
+		if( *fmt == '%' ) { fmt++; continue; }
+
+		arg.spec	= fmt - 1;
+		arg.stars	= 0;
+		arg.longs	= 0;
+
+		bool wide = false;
+
+		while( *fmt == '-' || *fmt == '+' || *fmt == ' ' || *fmt == '#' || *fmt == '0' ) fmt++;
+		while( *fmt == '*' || *fmt == '.' || (*fmt >= '0' && *fmt <= '9') )
+		{
+			if( *fmt == '*' ) arg.stars++;
+			fmt++;
+		}
+
+		while( *fmt == 'h' || *fmt == 'l' || *fmt == 'L' || *fmt == 'q' || *fmt == 'j' || *fmt == 'z' || *fmt == 't' )
+		{
+			if( *fmt == 'l' ) arg.longs++;
+			if( *fmt == 'L' || *fmt == 'q' || *fmt == 'j' ) wide = true;
+			fmt++;
+		}
+
+		if( fmt[0] == 'I' && fmt[1] == '6' && fmt[2] == '4' )
+		{
+			wide = true;
+			fmt += 3;
+		}
+
+		if( !*fmt ) return NULL;
+
+		char conv = *fmt++;
+		arg.speclen = fmt - arg.spec;
+
+		switch( conv )
+		{
+			case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+				arg.type = BTA_Int;
+				arg.size = (wide || arg.longs >= 2 || (arg.longs == 1 && longsize == 8)) ? 8 : 4;
+			return fmt;
+
+			case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+				arg.type = BTA_Double;
+				arg.size = 8;
+			return fmt;
+
+			case 's':
+				arg.type = BTA_String;
+				arg.size = 0;
+			return fmt;
+
+			case 'p':
+				arg.type = BTA_Pointer;
+				arg.size = 8;
+			return fmt;
+		}
+
+		// Unknown conversion; assume it doesn't take an argument.
+	}
+
+	return NULL;
+}
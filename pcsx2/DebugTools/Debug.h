@@ -35,9 +35,11 @@ namespace R5900
 
 	void disR5900F( std::string& output, u32 code );
 	void disR5900Fasm( std::string& output, u32 code, u32 pc);
-	void disR5900AddSym(u32 addr, const char *name);
+	void disR5900AddSym(u32 addr, const char *name, u32 size = 0);
 	const char* disR5900GetSym(u32 addr);
 	const char* disR5900GetUpperSym(u32 addr);
+	int disR5900GetSymCount();
+	const char* disR5900GetSymByIndex(int index, u32& addr, u32& size);
 	void disR5900FreeSyms();
 	void dFindSym( std::string& output, u32 addr );
 
@@ -75,6 +77,15 @@ struct SysTraceLogDescriptor
 	const char*			Prefix;
 };
 
+class SysTraceLog;
+
+// Binary trace mode (see DebugTools/BinaryTrace.cpp): records are queued raw and written
+// to emuLog.trace by a background thread, to be formatted offline by tools/tracefmt.
+// Only the format's address is queued, so trace formats must be string literals (or
+// otherwise outlive the log); pass generated text as a "%s" argument instead.
+extern void BinaryTrace_WriteV( const SysTraceLog& source, const char* fmt, va_list list );
+extern void BinaryTrace_Close();
+
 // --------------------------------------------------------------------------------------
 //  SysTraceLog
 // --------------------------------------------------------------------------------------
@@ -96,6 +107,31 @@ public:
 
 	void DoWrite( const char *fmt ) const;
 
+	bool Write( const char* fmt, ... ) const
+	{
+		va_list list;
+		va_start( list, fmt );
+		WriteV( fmt, list );
+		va_end( list );
+
+		return false;
+	}
+
+	bool WriteV( const char *fmt, va_list list ) const
+	{
+		if( EmuConfig.Trace.Binary )
+			BinaryTrace_WriteV( *this, fmt, list );
+		else
+			TextFileTraceLog::WriteV( fmt, list );
+
+		return false;
+	}
+
+	// Binary trace equivalents of ApplyPrefix: the pc/cycle pair is captured with each
+	// record, and the prefix strings are written once per source.
+	virtual void GetTraceContext( u32& pc, u32& cycle ) const { pc = cycle = 0; }
+	virtual bool GetTracePrefix( const char*& name, const char*& suffix ) const { return false; }
+
 	SysTraceLog& SetPrefix( const char* name )
 	{
 		PrePrefix = name;
@@ -112,6 +148,8 @@ public:
 	SysTraceLog_EE( const SysTraceLogDescriptor* desc ) : _parent( desc ) {}
 
 	void ApplyPrefix( FastFormatAscii& ascii ) const;
+	void GetTraceContext( u32& pc, u32& cycle ) const;
+	bool GetTracePrefix( const char*& name, const char*& suffix ) const;
 	bool IsActive() const
 	{
 		return EmuConfig.Trace.Enabled && Enabled && EmuConfig.Trace.EE.m_EnableAll;
@@ -128,6 +166,7 @@ public:
 	SysTraceLog_VIFcode( const SysTraceLogDescriptor* desc ) : _parent( desc ) {}
 
 	void ApplyPrefix( FastFormatAscii& ascii ) const;
+	bool GetTracePrefix( const char*& name, const char*& suffix ) const;
 };
 
 class SysTraceLog_EE_Disasm : public SysTraceLog_EE
@@ -184,6 +223,8 @@ public:
 	SysTraceLog_IOP( const SysTraceLogDescriptor* desc ) : _parent( desc ) {}
 
 	void ApplyPrefix( FastFormatAscii& ascii ) const;
+	void GetTraceContext( u32& pc, u32& cycle ) const;
+	bool GetTracePrefix( const char*& name, const char*& suffix ) const;
 	bool IsActive() const
 	{
 		return EmuConfig.Trace.Enabled && Enabled && EmuConfig.Trace.IOP.m_EnableAll;
@@ -166,6 +166,7 @@ typedef void (*TdisR5900F)DisFInterface;
 
 struct sSymbol {
 	u32 addr;
+	u32 size; // 0 if unknown
 	char name[256];
 };
 
@@ -173,7 +174,7 @@ static sSymbol *dSyms = NULL;
 static int nSymAlloc = 0;
 static int nSyms = 0;
 
-void disR5900AddSym(u32 addr, const char *name) {
+void disR5900AddSym(u32 addr, const char *name, u32 size) {
 
     if( !pxAssertDev(strlen(name) < sizeof(dSyms->name),
 		wxsFormat(L"String length out of bounds on debug symbol. Allowed=%d, Symbol=%d", sizeof(dSyms->name)-1, strlen(name)))
@@ -188,6 +189,7 @@ void disR5900AddSym(u32 addr, const char *name) {
 
 	if (dSyms == NULL) return;
 	dSyms[nSyms].addr = addr;
+	dSyms[nSyms].size = size;
 	strncpy(dSyms[nSyms].name, name, 256);
 	nSyms++;
 }
@@ -223,6 +225,17 @@ const char *disR5900GetUpperSym(u32 addr) {
 	return dSyms[j].name;
 }
 
+int disR5900GetSymCount() {
+	return (dSyms == NULL) ? 0 : nSyms;
+}
+
+const char *disR5900GetSymByIndex(int index, u32& addr, u32& size) {
+	if (dSyms == NULL || index < 0 || index >= nSyms) return NULL;
+	addr = dSyms[index].addr;
+	size = dSyms[index].size;
+	return dSyms[index].name;
+}
+
 void dFindSym( string& output, u32 addr )
 {
 	const char* label = disR5900GetSym( addr );
@@ -0,0 +1,390 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2010  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// --------------------------------------------------------------------------------------
+//  Guest Profiler
+// --------------------------------------------------------------------------------------
+// A sampling thread wakes up every millisecond and records where each guest CPU is:
+//
+//  * EE  - cpuRegs.pc, which the recompiler keeps at the start of the block being run (so
+//          samples resolve to recompiled blocks), plus what the EE thread is doing at the
+//          time: recompiled code, dispatcher, event test, memory handler or recompiling.
+//  * IOP - psxRegs.pc; with the IOP on the EE thread this is where it last stopped.
+//  * VUs - TPC of the running microprogram.  microVU only writes TPC back on exit, so
+//          samples land on the microprogram's start PC.
+//
+// Samples are only read, never synchronized with the emulation threads, so the sampler
+// costs the VM nothing beyond the zone stores (which are only generated while profiling).
+// Reports group EE samples by ELF symbol when the game's ELF has a symbol table.
+
+#include "PrecompiledHeader.h"
+#include "IopCommon.h"
+#include "SamplProf.h"
+#include "VUmicro.h"
+#include "MTVU.h"
+#include "Elfheader.h"
+#include "CDVD/CDVD.h"
+#include "AppConfig.h"
+
+#include "Utilities/PersistentThread.h"
+#include "Utilities/AsciiFile.h"
+
+#include <map>
+#include <vector>
+#include <algorithm>
+
+using namespace Threading;
+using namespace R5900;
+
+volatile u8 g_eeProfileZone = GPZ_Code;
+
+static const char* const GuestProfileZoneNames[GPZ_Count] =
+{
+	"recompiled code",
+	"dispatcher",
+	"memory handlers",
+	"recompiler",
+	"event tests",
+};
+
+typedef std::map<u32, u32> GuestSampleMap;
+
+struct GuestCpuSamples
+{
+	GuestSampleMap	pcs;
+	u32				total;
+
+	GuestCpuSamples() : total( 0 ) {}
+
+	void Add( u32 pc )
+	{
+		pcs[pc]++;
+		total++;
+	}
+};
+
+// Everything sampled since the last report
+struct GuestProfile
+{
+	u32					ticks;
+	u32					crc;			// ElfCRC when the first sample was taken
+	u32					eeZones[GPZ_Count];
+	GuestCpuSamples		ee;
+	GuestCpuSamples		iop;
+	GuestCpuSamples		vu[2];
+
+	GuestProfile() : ticks( 0 ), crc( 0 )
+	{
+		memzero( eeZones );
+	}
+};
+
+// --------------------------------------------------------------------------------------
+//  GuestProfilerThread
+// --------------------------------------------------------------------------------------
+class GuestProfilerThread : public pxThread
+{
+	typedef pxThread _parent;
+
+protected:
+	Mutex						m_lock;			// guards m_profile
+	Semaphore					m_wake;
+	volatile bool				m_quit;
+
+	ScopedPtr<GuestProfile>		m_profile;
+
+public:
+	GuestProfilerThread()
+		: pxThread( L"GuestProfiler" )
+	{
+		m_quit = false;
+		m_profile = new GuestProfile();
+	}
+
+	virtual ~GuestProfilerThread() throw()
+	{
+		Suspend();
+	}
+
+	void Resume();
+	void Suspend();
+	void Flush();
+
+protected:
+	void ExecuteTaskInThread();
+	void TakeSample();
+};
+
+static GuestProfilerThread s_GuestProfiler;
+
+void GuestProfilerThread::Resume()
+{
+	if( IsRunning() ) return;
+
+	m_quit = false;
+	m_wake.Reset();
+	Start();
+}
+
+void GuestProfilerThread::Suspend()
+{
+	if( !IsRunning() ) return;
+
+	m_quit = true;
+	m_wake.Post();
+	Block();
+}
+
+void GuestProfilerThread::ExecuteTaskInThread()
+{
+	while( !m_quit )
+	{
+		m_wake.WaitWithoutYield( wxTimeSpan( 0, 0, 0, 1 ) );
+		if( !m_quit ) TakeSample();
+	}
+}
+
+void GuestProfilerThread::TakeSample()
+{
+	u32 eepc	= cpuRegs.pc;
+	u32 zone	= eeEventTestIsActive ? GPZ_EventTest : g_eeProfileZone;
+	u32 ioppc	= psxRegs.pc;
+	u32 vpustat	= VU0.VI[REG_VPU_STAT].UL;
+
+	bool vu1Running = THREAD_VU1 ? !vu1Thread.IsDone() : !!(vpustat & 0x100);
+
+	ScopedLock lock( m_lock );
+	GuestProfile& prof( *m_profile );
+
+	if( !prof.ticks ) prof.crc = ElfCRC;
+	prof.ticks++;
+	prof.ee.Add( eepc );
+	prof.eeZones[std::min<u32>( zone, GPZ_Count-1 )]++;
+	prof.iop.Add( ioppc );
+
+	if( vpustat & 0x1 )	prof.vu[0].Add( VU0.VI[REG_TPC].UL );
+	if( vu1Running )	prof.vu[1].Add( VU1.VI[REG_TPC].UL );
+}
+
+// ------------------------------------------------------------------------
+//  Report
+// ------------------------------------------------------------------------
+struct GuestHotSpot
+{
+	u32			samples;
+	u32			pc;
+	const char*	name;
+
+	bool operator<( const GuestHotSpot& right ) const
+	{
+		return samples > right.samples;
+	}
+};
+
+// The ELF's function symbols, sorted by address so EE samples can be resolved to the
+// function containing them.  Built once per report.
+class GuestSymbolTable
+{
+protected:
+	struct Symbol
+	{
+		u32			addr;
+		u32			end;
+		const char*	name;
+
+		bool operator<( const Symbol& right ) const
+		{
+			return addr < right.addr;
+		}
+	};
+
+	std::vector<Symbol> m_syms;
+
+public:
+	GuestSymbolTable();
+
+	const char* Find( u32 pc ) const;
+	bool IsEmpty() const { return m_syms.empty(); }
+};
+
+GuestSymbolTable::GuestSymbolTable()
+{
+	const int count = disR5900GetSymCount();
+	m_syms.reserve( count );
+
+	for( int i = 0; i < count; ++i )
+	{
+		Symbol sym;
+		u32 size;
+		sym.name = disR5900GetSymByIndex( i, sym.addr, size );
+		sym.end  = sym.addr + size;
+		if( sym.name ) m_syms.push_back( sym );
+	}
+
+	std::sort( m_syms.begin(), m_syms.end() );
+
+	// Symbols end where the next one starts at the latest; those of unknown size are taken
+	// to run up to it.  The last symbol of unknown size covers nothing past its own address.
+	for( uint i = 0; i < m_syms.size(); ++i )
+	{
+		for( uint next = i + 1; next < m_syms.size(); ++next )
+		{
+			if( m_syms[next].addr == m_syms[i].addr ) continue;
+			if( m_syms[i].end == m_syms[i].addr || m_syms[i].end > m_syms[next].addr )
+				m_syms[i].end = m_syms[next].addr;
+			break;
+		}
+	}
+}
+
+// Name of the function containing an EE address, or NULL if no symbol covers it (kernel,
+// BIOS and unsymbolized modules).
+const char* GuestSymbolTable::Find( u32 pc ) const
+{
+	Symbol key;
+	key.addr = pc;
+
+	std::vector<Symbol>::const_iterator it( std::upper_bound( m_syms.begin(), m_syms.end(), key ) );
+	if( it == m_syms.begin() ) return NULL;
+	--it;
+
+	return (pc < it->end) ? it->name : NULL;
+}
+
+static const uint GuestReportLines = 40;
+
+static double _percent( u32 part, u32 total )
+{
+	return total ? (part * 100.0) / total : 0.0;
+}
+
+static void _writeHotSpots( AsciiFile& out, const char* title, std::vector<GuestHotSpot>& spots, u32 total )
+{
+	std::sort( spots.begin(), spots.end() );
+
+	out.Printf( "  %s:\n", title );
+	for( uint i = 0; i < spots.size() && i < GuestReportLines; ++i )
+	{
+		const GuestHotSpot& spot = spots[i];
+		if( spot.name )
+			out.Printf( "    %6.2f%%  %8u  %08x  %s\n", _percent( spot.samples, total ), spot.samples, spot.pc, spot.name );
+		else
+			out.Printf( "    %6.2f%%  %8u  %08x\n", _percent( spot.samples, total ), spot.samples, spot.pc );
+	}
+	out.Printf( "\n" );
+}
+
+static void _writeBlocks( AsciiFile& out, const char* title, const GuestCpuSamples& samples, const GuestSymbolTable* symbols )
+{
+	std::vector<GuestHotSpot> spots;
+	for( GuestSampleMap::const_iterator it = samples.pcs.begin(); it != samples.pcs.end(); ++it )
+	{
+		GuestHotSpot spot = { it->second, it->first, symbols ? symbols->Find( it->first ) : NULL };
+		spots.push_back( spot );
+	}
+
+	_writeHotSpots( out, title, spots, samples.total );
+}
+
+static void _writeReport( AsciiFile& out, const GuestProfile& prof )
+{
+	out.Printf( "PCSX2 guest profile for %s (CRC %08X)\n", DiscSerial.IsEmpty() ? "unknown disc" : (const char*)DiscSerial.ToUTF8(), prof.crc );
+	out.Printf( "%u samples, one per millisecond of emulation\n\n", prof.ticks );
+
+	out.Printf( "EE: %u samples\n", prof.ee.total );
+	for( int i = 0; i < GPZ_Count; ++i )
+		out.Printf( "  %-18s %6.2f%%\n", GuestProfileZoneNames[i], _percent( prof.eeZones[i], prof.ee.total ) );
+	out.Printf( "\n" );
+
+	const GuestSymbolTable symbols;
+
+	// Group the EE blocks by the function they belong to, if the ELF has symbols.
+	std::map<const char*, GuestHotSpot> functions;
+	for( GuestSampleMap::const_iterator it = prof.ee.pcs.begin(); it != prof.ee.pcs.end(); ++it )
+	{
+		const char* name = symbols.Find( it->first );
+		if( !name ) continue;
+
+		GuestHotSpot& func = functions[name];
+		if( !func.name )
+		{
+			func.name		= name;
+			func.pc			= it->first;
+			func.samples	= 0;
+		}
+		func.samples += it->second;
+	}
+
+	if( !functions.empty() )
+	{
+		std::vector<GuestHotSpot> spots;
+		for( std::map<const char*, GuestHotSpot>::const_iterator it = functions.begin(); it != functions.end(); ++it )
+			spots.push_back( it->second );
+
+		_writeHotSpots( out, "Hottest functions (first sampled block, function)", spots, prof.ee.total );
+	}
+
+	_writeBlocks( out, "Hottest blocks (start pc, function)", prof.ee, symbols.IsEmpty() ? NULL : &symbols );
+
+	out.Printf( "IOP: %u samples\n", prof.iop.total );
+	_writeBlocks( out, "Hottest blocks", prof.iop, NULL );
+
+	for( int vu = 0; vu < 2; ++vu )
+	{
+		out.Printf( "VU%d: busy in %.2f%% of samples\n", vu, _percent( prof.vu[vu].total, prof.ticks ) );
+		if( prof.vu[vu].total ) _writeBlocks( out, "Hottest microprograms (start pc)", prof.vu[vu], NULL );
+	}
+}
+
+// Writes the report for the samples taken so far and starts over.  Called on the core
+// thread when the running game changes or the VM resets or shuts down; samples from the
+// BIOS and boot loader end up in GuestProfile_00000000.txt.  The samples are handed over
+// to the report first, so the sampler isn't held up while it's written.
+void GuestProfilerThread::Flush()
+{
+	ScopedPtr<GuestProfile> prof;
+	{
+		ScopedLock lock( m_lock );
+		if( !m_profile->ticks ) return;
+
+		prof = m_profile.DetachPtr();
+		m_profile = new GuestProfile();
+	}
+
+	g_Conf->Folders.Logs.Mkdir();
+	wxString filename( Path::Combine( g_Conf->Folders.Logs, wxsFormat( L"GuestProfile_%08X.txt", prof->crc ) ) );
+
+	AsciiFile out( filename, L"w" );
+	if( out.IsOpened() )
+	{
+		_writeReport( out, *prof );
+		Console.WriteLn( Color_StrongBlack, L"GuestProfiler: wrote %s", filename.c_str() );
+	}
+}
+
+void GuestProfiler_Resume()
+{
+	if( GuestProfiler_IsEnabled() ) s_GuestProfiler.Resume();
+}
+
+void GuestProfiler_Suspend()
+{
+	s_GuestProfiler.Suspend();
+}
+
+void GuestProfiler_Flush()
+{
+	s_GuestProfiler.Flush();
+}
@@ -414,7 +414,16 @@ void ElfObject::loadSectionHeaders()
 		for(uint i = 1; i < (secthead[i_st].sh_size / sizeof(Elf32_Sym)); i++) {
 			if ((eS[i].st_value != 0) && (ELF32_ST_TYPE(eS[i].st_info) == 2))
 			{
-				R5900::disR5900AddSym(eS[i].st_value, &SymNames[eS[i].st_name]);
+				// Functions without a size at least end with their section
+				u32 size = eS[i].st_size;
+				if (!size && (eS[i].st_shndx < header.e_shnum))
+				{
+					const ELF_SHR& sect = secthead[eS[i].st_shndx];
+					if ((eS[i].st_value >= sect.sh_addr) && (eS[i].st_value < sect.sh_addr + sect.sh_size))
+						size = sect.sh_addr + sect.sh_size - eS[i].st_value;
+				}
+
+				R5900::disR5900AddSym(eS[i].st_value, &SymNames[eS[i].st_name], size);
 			}
 		}
 	}
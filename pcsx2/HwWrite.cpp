@@ -18,6 +18,7 @@
 #include "Common.h"
 #include "Hardware.h"
 #include "Gif_Unit.h"
+#include "MTIOP.h"
 
 #include "ps2/HwInternal.h"
 #include "ps2/eeHwTraceLog.inl"
@@ -118,6 +119,8 @@ void __fastcall _hwWrite32( u32 mem, u32 value )
 		case 0x0c:
 		case 0x0d:
 		case 0x0e:
+			// SIF channels hand data straight to the IOP's DMA state.
+			if (page == 0x0c) iopThread.WaitIOP();
 			if (!dmacWrite32<page>(mem, value)) return;
 		break;
 		
@@ -390,9 +390,9 @@ static void intExecute()
 {
 	try {
 		if (g_SkipBiosHack) {
-			do
+			// Not a do-while: execution may stop and resume right at EELOAD (boot snapshots)
+			while (cpuRegs.pc != EELOAD_START)
 				execI();
-			while (cpuRegs.pc != EELOAD_START);
 			eeloadReplaceOSDSYS();
 		}
 		if (ElfEntry != -1) {
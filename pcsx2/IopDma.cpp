@@ -17,6 +17,7 @@
 #include "IopCommon.h"
 
 #include "Sif.h"
+#include "MTIOP.h"
 
 using namespace R3000A;
 
@@ -194,6 +195,8 @@ void psxDma9(u32 madr, u32 bcr, u32 chcr)
 {
 	SIF_LOG("IOP: dmaSIF0 chcr = %lx, madr = %lx, bcr = %lx, tadr = %lx",	chcr, madr, bcr, HW_DMA9_TADR);
 
+	iopThread.SyncWithEE(); // SIF DMA touches the EE's DMAC state
+
 	sif0.iop.busy = true;
 	sif0.iop.end = false;
 
@@ -204,6 +207,8 @@ void psxDma10(u32 madr, u32 bcr, u32 chcr)
 {
 	SIF_LOG("IOP: dmaSIF1 chcr = %lx, madr = %lx, bcr = %lx",	chcr, madr, bcr);
 
+	iopThread.SyncWithEE(); // SIF DMA touches the EE's DMAC state
+
 	sif1.iop.busy = true;
 	sif1.iop.end = false;
 
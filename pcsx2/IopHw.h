@@ -322,6 +322,8 @@ enum IopEventId
 ,	IopEvt_USB = 21
 };
 
+extern CycleEventQueue iopEventQueue;
+
 extern void PSX_INT( IopEventId n, s32 ecycle);
 
 extern void psxSetNextBranch( u32 startCycle, s32 delta );
@@ -16,6 +16,7 @@
 
 #include "PrecompiledHeader.h"
 #include "IopCommon.h"
+#include "MTIOP.h"
 
 uptr *psxMemWLUT = NULL;
 const uptr *psxMemRLUT = NULL;
@@ -182,6 +183,7 @@ u16 __fastcall iopMemRead16(u32 mem)
 		{
 			if (t == 0x1d00)
 			{
+				iopThread.SyncWithEE();
 				u16 ret;
 				switch(mem & 0xF0)
 				{
@@ -242,6 +244,7 @@ u32 __fastcall iopMemRead32(u32 mem)
 		{
 			if (t == 0x1d00)
 			{
+				iopThread.SyncWithEE();
 				u32 ret;
 				switch(mem & 0x8F0)
 				{
@@ -316,6 +319,7 @@ void __fastcall iopMemWrite8(u32 mem, u8 value)
 		{
 			if (t == 0x1d00)
 			{
+				iopThread.SyncWithEE();
 				Console.WriteLn("sw8 [0x%08X]=0x%08X", mem, value);
 				psxSu8(mem) = value;
 				return;
@@ -359,6 +363,7 @@ void __fastcall iopMemWrite16(u32 mem, u16 value)
 		{
 			if (t == 0x1d00)
 			{
+				iopThread.SyncWithEE();
 				switch (mem & 0x8f0)
 				{
 					case 0x10:
@@ -429,6 +434,7 @@ void __fastcall iopMemWrite32(u32 mem, u32 value)
 		{
 			if (t == 0x1d00)
 			{
+				iopThread.SyncWithEE();
 				MEM_LOG("iop Sif reg write %x value %x", mem, value);
 				switch (mem & 0x8f0)
 				{
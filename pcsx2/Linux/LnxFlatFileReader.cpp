@@ -1,11 +1,60 @@
 #include "PrecompiledHeader.h"
 #include "AsyncFileReader.h"
+#include "Utilities/PersistentThread.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+// O_DIRECT transfers must be aligned (offset, length and buffer) to the logical block size
+// of the underlying device.  4k covers everything we're likely to see.
+static const uint DirectAlign = 4096;
+static const uint BounceSize = 256 * 1024;
+
+// Note: pread64 rather than pread; the build doesn't set _FILE_OFFSET_BITS=64, and DVD9
+// images are well past 2GB.
+
+// --------------------------------------------------------------------------------------
+//  FlatFileReaderWorker
+// --------------------------------------------------------------------------------------
+// Services queued reads until the reader stops its workers.
+class FlatFileReaderWorker : public Threading::pxThread
+{
+	typedef pxThread _parent;
+
+protected:
+	FlatFileReader& m_reader;
+
+public:
+	FlatFileReaderWorker(FlatFileReader& reader)
+		: pxThread(L"FlatFileReader")
+		, m_reader(reader)
+	{
+	}
+
+protected:
+	void ExecuteTaskInThread()
+	{
+		m_reader.WorkerLoop();
+	}
+};
 
 FlatFileReader::FlatFileReader(void)
 {
 	m_blocksize = 2048;
-	m_fd = 0;
-	m_aio_context = 0;
+	m_fd = -1;
+	m_direct = false;
+	m_mapping = NULL;
+	m_mapsize = 0;
+	m_head = m_next = m_tail = 0;
+	m_numworkers = 0;
+	m_quit = false;
+
+	for (uint i = 0; i < NumWorkers; i++)
+		m_workers[i] = NULL;
+
+	for (uint i = 0; i < MaxRequests; i++)
+		m_requests[i].bounce = NULL;
 }
 
 FlatFileReader::~FlatFileReader(void)
@@ -15,14 +64,80 @@ FlatFileReader::~FlatFileReader(void)
 
 bool FlatFileReader::Open(const wxString& fileName)
 {
+	Close();
+
 	m_filename = fileName;
 
-	int err = io_setup(64, &m_aio_context);
-	if (err) return false;
+	if (EmuConfig.CdvdDirectReads)
+	{
+		m_fd = wxOpen(fileName, O_RDONLY | O_DIRECT, 0);
+		m_direct = (m_fd != -1);
+
+		// Not every filesystem supports O_DIRECT (tmpfs, some FUSE mounts); fall back to
+		// ordinary cached reads rather than failing the open.
+		if (!m_direct)
+			Console.Warning(L"FlatFileReader: O_DIRECT unavailable for %s, using cached reads.", fileName.c_str());
+	}
+
+	if (m_fd == -1)
+		m_fd = wxOpen(fileName, O_RDONLY, 0);
+
+	if (m_fd == -1)
+		return false;
+
+	if (EmuConfig.CdvdMappedReads && !m_direct)
+	{
+		// This is a 32 bit process, so DVD images usually won't fit; that's fine, they simply
+		// get read through the worker threads like everything else.
+		u64 size = Path::GetFileSize(fileName);
+		if (size && size == (size_t)size)
+		{
+			void* mapping = mmap(NULL, (size_t)size, PROT_READ, MAP_SHARED, m_fd, 0);
+			if (mapping != MAP_FAILED)
+			{
+				m_mapping = (u8*)mapping;
+				m_mapsize = size;
+			}
+			else
+				DevCon.WriteLn(L"FlatFileReader: could not map %s, using reads.", fileName.c_str());
+		}
+	}
+
+	if (m_direct)
+	{
+		for (uint i = 0; i < MaxRequests; i++)
+		{
+			if (posix_memalign((void**)&m_requests[i].bounce, DirectAlign, BounceSize))
+			{
+				m_requests[i].bounce = NULL;
+				Close();
+				return false;
+			}
+		}
+	}
+
+	m_quit = false;
+	for (m_numworkers = 0; m_numworkers < NumWorkers; m_numworkers++)
+	{
+		ScopedPtr<FlatFileReaderWorker> worker(new FlatFileReaderWorker(*this));
+		try
+		{
+			worker->Start();
+		}
+		catch (Exception::ThreadCreationError&)
+		{
+			break;
+		}
+		m_workers[m_numworkers] = worker.DetachPtr();
+	}
 
-    m_fd = wxOpen(fileName, O_RDONLY, 0);
+	if (!m_numworkers)
+	{
+		Close();
+		return false;
+	}
 
-	return (m_fd != 0);
+	return true;
 }
 
 int FlatFileReader::ReadSync(void* pBuffer, uint sector, uint count)
@@ -33,54 +148,176 @@ int FlatFileReader::ReadSync(void* pBuffer, uint sector, uint count)
 
 void FlatFileReader::BeginRead(void* pBuffer, uint sector, uint count)
 {
-	u64 offset;
-	offset = sector * (u64)m_blocksize + m_dataoffset;
+	ScopedLock lock(m_lock);
 
-	u32 bytesToRead = count * m_blocksize;
+	pxAssertDev(m_tail - m_head < MaxRequests, "FlatFileReader: too many reads in flight.");
 
-	struct iocb iocb;
-	struct iocb* iocbs = &iocb;
+	ReadRequest& req = m_requests[m_tail % MaxRequests];
+	req.buffer = pBuffer;
+	req.offset = sector * (u64)m_blocksize + m_dataoffset;
+	req.bytes = count * m_blocksize;
+	req.result = -1;
+	m_tail++;
 
-	io_prep_pread(&iocb, m_fd, pBuffer, bytesToRead, offset);
-	io_submit(m_aio_context, 1, &iocbs);
+	lock.Release();
+	m_pending.Post();
 }
 
 int FlatFileReader::FinishRead(void)
 {
-	u32 bytes;
-
-	int min_nr = 1;
-	int max_nr = 1;
-    struct io_event* events = new io_event[max_nr];
-
-	int event = io_getevents(m_aio_context, min_nr, max_nr, events, NULL);
-	if (event < 1) {
+	if (m_head == m_tail)
 		return -1;
-	}
 
-	return 1;
+	ReadRequest& req = m_requests[m_head % MaxRequests];
+	req.done.Wait();
+
+	int result = req.result;
+	m_head++;
+	return result;
 }
 
 void FlatFileReader::CancelRead(void)
 {
-	// Will be done when m_aio_context context is destroyed
-	// Note: io_cancel exists but need the iocb structure as parameter
-	// int io_cancel(aio_context_t ctx_id, struct iocb *iocb,
-	//                struct io_event *result);
+	// Requests nobody has started yet are simply dropped, but the caller owns the
+	// destination buffers, so any read already in progress has to be waited for.
+	ScopedLock lock(m_lock);
+	uint started = m_next;
+	m_next = m_tail;
+	lock.Release();
+
+	for (; m_head != started; m_head++)
+		m_requests[m_head % MaxRequests].done.Wait();
+
+	m_head = m_tail;
 }
 
 void FlatFileReader::Close(void)
 {
+	if (m_numworkers)
+	{
+		CancelRead();
+		StopWorkers();
+	}
 
-	if (m_fd) close(m_fd);
+	if (m_mapping)
+		munmap(m_mapping, (size_t)m_mapsize);
 
-	io_destroy(m_aio_context);
+	if (m_fd != -1)
+		close(m_fd);
 
-	m_fd = 0;
-	m_aio_context = 0;
+	for (uint i = 0; i < MaxRequests; i++)
+	{
+		free(m_requests[i].bounce);
+		m_requests[i].bounce = NULL;
+	}
+
+	m_fd = -1;
+	m_direct = false;
+	m_mapping = NULL;
+	m_mapsize = 0;
+	m_head = m_next = m_tail = 0;
 }
 
 uint FlatFileReader::GetBlockCount(void) const
 {
 	return (int)(Path::GetFileSize(m_filename) / m_blocksize);
 }
+
+void FlatFileReader::StopWorkers()
+{
+	m_quit = true;
+	m_pending.Post(m_numworkers);
+
+	for (uint i = 0; i < m_numworkers; i++)
+	{
+		m_workers[i]->Block();
+		safe_delete(m_workers[i]);
+	}
+
+	m_numworkers = 0;
+	m_pending.Reset();
+}
+
+void FlatFileReader::WorkerLoop()
+{
+	while (true)
+	{
+		m_pending.WaitWithoutYield();
+
+		ScopedLock lock(m_lock);
+		if (m_quit)
+			return;
+
+		// Cancelled requests leave stale posts behind.
+		if (m_next == m_tail)
+			continue;
+
+		ReadRequest& req = m_requests[m_next % MaxRequests];
+		m_next++;
+		lock.Release();
+
+		req.result = Service(req);
+		req.done.Post();
+	}
+}
+
+// Performs one read on a worker thread.  Returns the number of bytes read, or -1 on error.
+int FlatFileReader::Service(ReadRequest& req)
+{
+	u8* dst = (u8*)req.buffer;
+	u64 pos = req.offset;
+	u64 end = req.offset + req.bytes;
+
+	if (m_mapping)
+	{
+		if (pos >= m_mapsize)
+			return 0;
+
+		u32 bytes = (u32)(std::min(end, m_mapsize) - pos);
+		memcpy_fast(dst, m_mapping + pos, bytes);
+		return bytes;
+	}
+
+	while (pos < end)
+	{
+		ssize_t got;
+		u32 skip = 0;
+		u32 want;
+
+		if (m_direct)
+		{
+			// Read whole aligned blocks into the bounce buffer and copy out the bit we need.
+			u64 aligned = pos & ~(u64)(DirectAlign - 1);
+			skip = (u32)(pos - aligned);
+			want = (u32)std::min<u64>(BounceSize, (end - aligned + DirectAlign - 1) & ~(u64)(DirectAlign - 1));
+			got = pread64(m_fd, req.bounce, want, aligned);
+		}
+		else
+		{
+			want = (u32)(end - pos);
+			got = pread64(m_fd, dst, want, pos);
+		}
+
+		if (got < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+
+		if ((u32)got <= skip)
+			break;
+
+		u32 copied = (u32)std::min<u64>(got - skip, end - pos);
+		if (m_direct)
+			memcpy_fast(dst, req.bounce + skip, copied);
+
+		dst += copied;
+		pos += copied;
+
+		if ((u32)got < want)
+			break;	// end of file
+	}
+
+	return (int)(pos - req.offset);
+}
@@ -0,0 +1,85 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2010  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "SamplProf.h"
+
+#include "Utilities/Threading.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// --------------------------------------------------------------------------------------
+//  perf map support
+// --------------------------------------------------------------------------------------
+// perf (and anything else that follows its convention) looks for /tmp/perf-<pid>.map to
+// name samples that land in anonymous executable memory.  Each line is
+// "<start> <size> <name>", in hex.  Plugins that generate code (GSdx) append to the same
+// file, so every line goes out in a single write() on an O_APPEND descriptor.
+//
+// Recompiler caches get reset and reused, so an address can be named more than once over a
+// session.  Profile after the cache has settled (or with a large cache) for clean results.
+
+static Threading::Mutex	s_perfMapLock;
+static volatile int		s_perfMap		= -1;
+static volatile bool	s_perfMapFailed	= false;
+
+static int GetPerfMap()
+{
+	if (s_perfMap != -1 || s_perfMapFailed) return s_perfMap;
+
+	Threading::ScopedLock lock(s_perfMapLock);
+	if (s_perfMap == -1 && !s_perfMapFailed)
+	{
+		char path[64];
+		snprintf(path, sizeof(path), "/tmp/perf-%d.map", (int)getpid());
+
+		int fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+		if (fd == -1)
+		{
+			Console.Warning("Profiler: could not create %s, recompiled blocks won't be named.", path);
+			s_perfMapFailed = true;
+		}
+		else
+		{
+			Console.WriteLn("Profiler: writing recompiled block names to %s", path);
+			s_perfMap = fd;
+		}
+	}
+	return s_perfMap;
+}
+
+void ProfilerRegisterBlock(const void* code, u32 size, const char* fmt, ...)
+{
+	if (!size) return;
+
+	int fd = GetPerfMap();
+	if (fd == -1) return;
+
+	char line[256];
+	int len = snprintf(line, sizeof(line), "%lx %x ", (unsigned long)(uptr)code, size);
+
+	va_list list;
+	va_start(list, fmt);
+	int namelen = vsnprintf(line + len, sizeof(line) - len - 1, fmt, list);
+	va_end(list);
+
+	if (namelen < 0) return;
+	len = std::min<int>(len + namelen, sizeof(line) - 2);
+	line[len++] = '\n';
+
+	if (write(fd, line, len) != len)
+		DevCon.Warning("Profiler: write to the perf map failed.");
+}
@@ -0,0 +1,113 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2010  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Common.h"
+#include "MTIOP.h"
+#include "R3000A.h"
+
+IOP_Thread iopThread;
+
+IOP_Thread::IOP_Thread()
+{
+	m_name       = L"MTIOP";
+	m_busy       = false;
+	m_cycles     = 0;
+	m_eeParked   = false;
+	m_iopWaiting = false;
+	eeSyncRequest = 0;
+}
+
+IOP_Thread::~IOP_Thread() throw()
+{
+	pxThread::Cancel();
+}
+
+void IOP_Thread::Launch(s32 eeCycles)
+{
+	pxAssert(!m_busy && !IsSelf());
+	if (!IsRunning()) Start();
+
+	m_cycles   = eeCycles;
+	m_eeParked = false;
+	m_busy     = true;
+	m_semaSlice.Post();
+}
+
+void IOP_Thread::WaitIOP()
+{
+	if (!m_busy) return;
+	pxAssert(!IsSelf());
+
+	{
+		ScopedLock lock(m_mtxPark);
+		m_eeParked = true;
+		eeSyncRequest = 0;
+		if (m_iopWaiting) {
+			m_iopWaiting = false;
+			m_semaParked.Post();
+		}
+	}
+
+	m_semaDone.WaitWithoutYield();
+	m_busy   = false;
+	EEsCycle = m_cycles;
+	RethrowException();
+}
+
+void IOP_Thread::SyncWithEE()
+{
+	if (!IsSelf() || m_eeParked) return;
+
+	{
+		ScopedLock lock(m_mtxPark);
+		if (m_eeParked) return;
+		m_iopWaiting = true;
+
+		// Ask the EE to run its next event test (and park) as soon as possible.  The EE's
+		// event scheduler belongs to the EE thread, so g_nextEventCycle can't be touched here.
+		AtomicExchange(eeSyncRequest, 1);
+	}
+
+	m_semaParked.WaitWithoutYield();
+}
+
+void IOP_Thread::ExecuteTaskInThread()
+{
+	PCSX2_PAGEFAULT_PROTECT {
+		for(;;) {
+			m_semaSlice.WaitWithoutYield();
+			RunSlice();
+			m_semaDone.Post();
+		}
+	} PCSX2_PAGEFAULT_EXCEPT;
+}
+
+void IOP_Thread::RunSlice()
+{
+	try {
+		// Same as the inline path in _cpuEventTest_Shared: the IOP acts on the state the
+		// EE has given it before executing any code.
+		iopEventTest();
+
+		if (iopEventAction) {
+			m_cycles = psxCpu->ExecuteBlock(m_cycles);
+			iopEventAction = false;
+		}
+	}
+	catch (BaseException& ex) {
+		m_except = ex.Clone();
+	}
+}
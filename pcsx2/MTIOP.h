@@ -0,0 +1,72 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2010  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "System/SysThreads.h"
+
+// Notes:
+// - Launch() and WaitIOP() must only be called from the EE thread; SyncWithEE() is a
+//   no-op unless called from the IOP thread.
+// - The IOP runs one timeslice (the EE's cycle credit, EEsCycle) per Launch.  The EE
+//   keeps running until its next event test, at most IopThreadSlack cycles later, and
+//   then parks in WaitIOP() until the slice is complete.  This bounds the skew between
+//   the two cpus to the slack plus one IOP slice.
+// - Any IOP access to state shared with the EE (SBUS registers, SIF DMA) calls
+//   SyncWithEE() first, which blocks the IOP until the EE has parked.  EE accesses to
+//   IOP state likewise call WaitIOP() first.
+class IOP_Thread : public pxThread {
+	__aligned(4) volatile bool m_busy;   // slice in flight (EE-owned)
+	__aligned(4) s32  m_cycles;          // EEsCycle in, leftover cycles out
+	__aligned(4) bool m_eeParked;        // EE is blocked in WaitIOP (guarded by m_mtxPark)
+	__aligned(4) bool m_iopWaiting;      // IOP is blocked in SyncWithEE (guarded by m_mtxPark)
+	__aligned(4) Mutex     m_mtxPark;
+	__aligned(4) Semaphore m_semaSlice;
+	__aligned(4) Semaphore m_semaDone;
+	__aligned(4) Semaphore m_semaParked;
+
+public:
+	// Set by SyncWithEE() while the IOP is waiting for the EE to park; the EE checks it at
+	// the end of every block (or branch, on the interpreter) and runs its event test early.
+	__aligned(4) volatile u32 eeSyncRequest;
+
+	// Held by both recompilers while compiling or resetting (and by vtlb_dynarec_init),
+	// since iCore's register allocation state, and the emitter's write pointer when it
+	// isn't thread local, are shared between the EE and IOP recs.  Recursive, as compiling
+	// can trigger a reset.  Block clears don't need it: they only touch their own rec's
+	// block tables, and the other cpu's memory is only written with it parked (see above).
+	__aligned(4) MutexRecursive mtxRecompile;
+
+	IOP_Thread();
+	virtual ~IOP_Thread() throw();
+
+	// Starts an IOP timeslice of the given number of EE cycles.
+	void Launch(s32 eeCycles);
+
+	// Waits till the IOP timeslice in flight (if any) is done, and writes back EEsCycle.
+	void WaitIOP();
+
+	// Blocks the IOP thread until the EE has parked in WaitIOP().
+	void SyncWithEE();
+
+	bool IsBusy() const { return m_busy; }
+
+protected:
+	void ExecuteTaskInThread();
+
+private:
+	void RunSlice();
+};
+
+extern IOP_Thread iopThread;
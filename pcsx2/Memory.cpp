@@ -41,6 +41,7 @@ BIOS
 #include "GS.h"
 #include "VUmicro.h"
 #include "MTVU.h"
+#include "MTIOP.h"
 
 #include "ps2/HwInternal.h"
 #include "ps2/BiosTools.h"
@@ -155,7 +156,8 @@ void memMapPhy()
 
 	// IOP memory
 	// (used by the EE Bios Kernel during initial hardware initialization, Apps/Games
-	//  are "supposed" to use the thread-safe SIF instead.)
+	//  are "supposed" to use the thread-safe SIF instead.  Note that direct access isn't
+	//  synchronized with the threaded IOP.)
 	vtlb_MapBlock(iopMem->Main,0x1c000000,0x00800000);
 
 	// Generic Handlers; These fallback to mem* stuff...
@@ -435,6 +437,14 @@ static void __fastcall _ext_memWrite128(u32 mem, const mem128_t *value)
 #define vtlb_RegisterHandlerTempl1(nam,t) vtlb_RegisterHandler(nam##Read8<t>,nam##Read16<t>,nam##Read32<t>,nam##Read64<t>,nam##Read128<t>, \
 															   nam##Write8<t>,nam##Write16<t>,nam##Write32<t>,nam##Write64<t>,nam##Write128<t>)
 
+// EE access to the IOP's "secret" hw registers must not race a threaded IOP.
+template<vtlbMemR8FP*  fn> static mem8_t  __fastcall iopHwSyncRead8 (u32 mem) { iopThread.WaitIOP(); return fn(mem); }
+template<vtlbMemR16FP* fn> static mem16_t __fastcall iopHwSyncRead16(u32 mem) { iopThread.WaitIOP(); return fn(mem); }
+template<vtlbMemR32FP* fn> static mem32_t __fastcall iopHwSyncRead32(u32 mem) { iopThread.WaitIOP(); return fn(mem); }
+template<vtlbMemW8FP*  fn> static void __fastcall iopHwSyncWrite8 (u32 mem, mem8_t  value) { iopThread.WaitIOP(); fn(mem, value); }
+template<vtlbMemW16FP* fn> static void __fastcall iopHwSyncWrite16(u32 mem, mem16_t value) { iopThread.WaitIOP(); fn(mem, value); }
+template<vtlbMemW32FP* fn> static void __fastcall iopHwSyncWrite32(u32 mem, mem32_t value) { iopThread.WaitIOP(); fn(mem, value); }
+
 typedef void __fastcall ClearFunc_t( u32 addr, u32 qwc );
 
 template<int vunum> static __fi void ClearVuFunc(u32 addr, u32 size) {
@@ -758,24 +768,26 @@ void eeMemoryReserve::Reset()
 
 	using namespace IopMemory;
 
+#define iopHwHandlerTmpl(page) \
+	iopHwSyncRead8<iopHwRead8_##page>, iopHwSyncRead16<iopHwRead16_##page>, iopHwSyncRead32<iopHwRead32_##page>, \
+	_ext_memRead64<2>, _ext_memRead128<2>, \
+	iopHwSyncWrite8<iopHwWrite8_##page>, iopHwSyncWrite16<iopHwWrite16_##page>, iopHwSyncWrite32<iopHwWrite32_##page>, \
+	_ext_memWrite64<2>, _ext_memWrite128<2>
+
 	tlb_fallback_2 = vtlb_RegisterHandler(
-		iopHwRead8_generic, iopHwRead16_generic, iopHwRead32_generic, _ext_memRead64<2>, _ext_memRead128<2>,
-		iopHwWrite8_generic, iopHwWrite16_generic, iopHwWrite32_generic, _ext_memWrite64<2>, _ext_memWrite128<2>
+		iopHwHandlerTmpl(generic)
 	);
 
 	iopHw_by_page_01 = vtlb_RegisterHandler(
-		iopHwRead8_Page1, iopHwRead16_Page1, iopHwRead32_Page1, _ext_memRead64<2>, _ext_memRead128<2>,
-		iopHwWrite8_Page1, iopHwWrite16_Page1, iopHwWrite32_Page1, _ext_memWrite64<2>, _ext_memWrite128<2>
+		iopHwHandlerTmpl(Page1)
 	);
 
 	iopHw_by_page_03 = vtlb_RegisterHandler(
-		iopHwRead8_Page3, iopHwRead16_Page3, iopHwRead32_Page3, _ext_memRead64<2>, _ext_memRead128<2>,
-		iopHwWrite8_Page3, iopHwWrite16_Page3, iopHwWrite32_Page3, _ext_memWrite64<2>, _ext_memWrite128<2>
+		iopHwHandlerTmpl(Page3)
 	);
 
 	iopHw_by_page_08 = vtlb_RegisterHandler(
-		iopHwRead8_Page8, iopHwRead16_Page8, iopHwRead32_Page8, _ext_memRead64<2>, _ext_memRead128<2>,
-		iopHwWrite8_Page8, iopHwWrite16_Page8, iopHwWrite32_Page8, _ext_memWrite64<2>, _ext_memWrite128<2>
+		iopHwHandlerTmpl(Page8)
 	);
 
 
@@ -26,6 +26,7 @@ void TraceLogFilters::LoadSave( IniInterface& ini )
 	ScopedIniGroup path( ini, L"TraceLog" );
 
 	IniEntry( Enabled );
+	IniEntry( Binary );
 	
 	// Retaining backwards compat of the trace log enablers isn't really important, and
 	// doing each one by hand would be murder.  So let's cheat and just save it as an int:
@@ -42,6 +43,8 @@ Pcsx2Config::SpeedhackOptions::SpeedhackOptions()
 	WaitLoop = true;
 	IntcStat = true;
 	vuFlagHack = true;
+
+	IopThreadSlack = 1024;
 }
 
 Pcsx2Config::SpeedhackOptions& Pcsx2Config::SpeedhackOptions::DisableAll()
@@ -64,6 +67,9 @@ void Pcsx2Config::SpeedhackOptions::LoadSave( IniInterface& ini )
 	IniBitBool( WaitLoop );
 	IniBitBool( vuFlagHack );
 	IniBitBool( vuThread );
+	IniBitBool( iopThread );
+	IniBitBool( vuOptTier );
+	IniEntry( IopThreadSlack );
 }
 
 void Pcsx2Config::ProfilerOptions::LoadSave( IniInterface& ini )
@@ -75,6 +81,7 @@ void Pcsx2Config::ProfilerOptions::LoadSave( IniInterface& ini )
 	IniBitBool( RecBlocks_IOP );
 	IniBitBool( RecBlocks_VU0 );
 	IniBitBool( RecBlocks_VU1 );
+	IniBitBool( GuestSamples );
 }
 
 Pcsx2Config::RecompilerOptions::RecompilerOptions()
@@ -88,6 +95,7 @@ Pcsx2Config::RecompilerOptions::RecompilerOptions()
 
 	EnableEE	= true;
 	EnableEECache = false;
+	EnableFastmem = true;
 	EnableIOP	= true;
 	EnableVU0	= true;
 	EnableVU1	= true;
@@ -146,6 +154,7 @@ void Pcsx2Config::RecompilerOptions::LoadSave( IniInterface& ini )
 	IniBitBool( EnableEE );
 	IniBitBool( EnableIOP );
 	IniBitBool( EnableEECache );
+	IniBitBool( EnableFastmem );
 	IniBitBool( EnableVU0 );
 	IniBitBool( EnableVU1 );
 
@@ -385,13 +394,17 @@ void Pcsx2Config::LoadSave( IniInterface& ini )
 
 	IniBitBool( CdvdVerboseReads );
 	IniBitBool( CdvdDumpBlocks );
+	IniBitBool( CdvdDirectReads );
+	IniBitBool( CdvdMappedReads );
 	IniBitBool( EnablePatches );
 	IniBitBool( EnableCheats );
 	IniBitBool( ConsoleToStdio );
 	IniBitBool( HostFs );
+	IniBitBool( BootSnapshots );
 
 	IniBitBool( BackupSavestate );
 	IniBitBool( McdEnableEjection );
+	IniBitBool( McdBufferedWrites );
 	IniBitBool( MultitapPort0_Enabled );
 	IniBitBool( MultitapPort1_Enabled );
 
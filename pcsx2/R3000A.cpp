@@ -19,6 +19,7 @@
 
 #include "Sio.h"
 #include "Sif.h"
+#include "MTIOP.h"
 
 using namespace R3000A;
 
@@ -54,6 +55,8 @@ void psxReset()
 {
 	memzero(psxRegs);
 
+	iopEventQueue.Reset();
+
 	psxRegs.pc = 0xbfc00000; // Start in bootstrap
 	psxRegs.CP0.n.Status = 0x10900000; // COP0 enabled | BEV = 1 | TS = 1
 	psxRegs.CP0.n.PRid   = 0x0000001f; // PRevID = Revision ID, same as the IOP R3000A
@@ -108,6 +111,16 @@ void __fastcall psxException(u32 code, u32 bd)
 	}*/
 }
 
+CycleEventQueue iopEventQueue(
+	(1 << IopEvt_SIF0)		| (1 << IopEvt_SIF1)		|
+#ifndef SIO_INLINE_IRQS
+	(1 << IopEvt_SIO)		|
+#endif
+	(1 << IopEvt_CdvdRead)	| (1 << IopEvt_Cdvd)		| (1 << IopEvt_Dma11)		|
+	(1 << IopEvt_Dma12)		| (1 << IopEvt_Cdrom)		| (1 << IopEvt_CdromRead)	|
+	(1 << IopEvt_DEV9)		| (1 << IopEvt_USB)
+);
+
 __fi void psxSetNextBranch( u32 startCycle, s32 delta )
 {
 	// typecast the conditional to signed so that things don't blow up
@@ -149,6 +162,8 @@ __fi void PSX_INT( IopEventId n, s32 ecycle )
 	psxRegs.sCycle[n] = psxRegs.cycle;
 	psxRegs.eCycle[n] = ecycle;
 
+	iopEventQueue.Schedule( n, psxRegs.sCycle[n] + psxRegs.eCycle[n] );
+
 	psxSetNextBranchDelta( ecycle );
 
 	if( iopCycleEE < 0 )
@@ -161,42 +176,46 @@ __fi void PSX_INT( IopEventId n, s32 ecycle )
 	}
 }
 
-static __fi void IopTestEvent( IopEventId n, void (*callback)() )
+static __fi void IopTestEvent( u32 due, IopEventId n, void (*callback)() )
 {
-	if( !(psxRegs.interrupt & (1 << n)) ) return;
+	if( !(due & (1 << n)) || !(psxRegs.interrupt & (1 << n)) ) return;
 
+	// Check the cycle again, an earlier callback may have rethrown the event (which queued it again).
 	if( psxTestCycle( psxRegs.sCycle[n], psxRegs.eCycle[n] ) )
 	{
 		psxRegs.interrupt &= ~(1 << n);
 		callback();
 	}
-	else
-		psxSetNextBranch( psxRegs.sCycle[n], psxRegs.eCycle[n] );
 }
 
 static __fi void _psxTestInterrupts()
 {
-	IopTestEvent(IopEvt_SIF0,		sif0Interrupt);	// SIF0
-	IopTestEvent(IopEvt_SIF1,		sif1Interrupt);	// SIF1
-#ifndef SIO_INLINE_IRQS
-	IopTestEvent(IopEvt_SIO,		sioInterrupt);
-#endif
-	IopTestEvent(IopEvt_CdvdRead,	cdvdReadInterrupt);
+	iopEventQueue.Update( psxRegs.interrupt, psxRegs.sCycle, (u32*)psxRegs.eCycle );
 
-	// Profile-guided Optimization (sorta)
-	// The following ints are rarely called.  Encasing them in a conditional
-	// as follows helps speed up most games.
+	const u32 due = iopEventQueue.PopDue( psxRegs.cycle, psxRegs.interrupt, psxRegs.sCycle, (u32*)psxRegs.eCycle );
 
-	if( psxRegs.interrupt & ( (1ul<<5) | (3ul<<11) | (3ul<<20) | (3ul<<17) ) )
+	// Events which are due together are still handled in their traditional order.
+	if( due )
 	{
-		IopTestEvent(IopEvt_Cdvd,		cdvdActionInterrupt);
-		IopTestEvent(IopEvt_Dma11,		psxDMA11Interrupt);	// SIO2
-		IopTestEvent(IopEvt_Dma12,		psxDMA12Interrupt);	// SIO2
-		IopTestEvent(IopEvt_Cdrom,		cdrInterrupt);
-		IopTestEvent(IopEvt_CdromRead,	cdrReadInterrupt);
-		IopTestEvent(IopEvt_DEV9,		dev9Interrupt);
-		IopTestEvent(IopEvt_USB,		usbInterrupt);
+		IopTestEvent(due, IopEvt_SIF0,		sif0Interrupt);	// SIF0
+		IopTestEvent(due, IopEvt_SIF1,		sif1Interrupt);	// SIF1
+#ifndef SIO_INLINE_IRQS
+		IopTestEvent(due, IopEvt_SIO,		sioInterrupt);
+#endif
+		IopTestEvent(due, IopEvt_CdvdRead,	cdvdReadInterrupt);
+
+		IopTestEvent(due, IopEvt_Cdvd,		cdvdActionInterrupt);
+		IopTestEvent(due, IopEvt_Dma11,		psxDMA11Interrupt);	// SIO2
+		IopTestEvent(due, IopEvt_Dma12,		psxDMA12Interrupt);	// SIO2
+		IopTestEvent(due, IopEvt_Cdrom,		cdrInterrupt);
+		IopTestEvent(due, IopEvt_CdromRead,	cdrReadInterrupt);
+		IopTestEvent(due, IopEvt_DEV9,		dev9Interrupt);
+		IopTestEvent(due, IopEvt_USB,		usbInterrupt);
 	}
+
+	u32 next;
+	if( iopEventQueue.GetNext( next ) )
+		psxSetNextBranch( psxRegs.cycle, next - psxRegs.cycle );
 }
 
 __ri void iopEventTest()
@@ -241,7 +260,14 @@ void iopTestIntc()
 	if( psxHu32(0x1078) == 0 ) return;
 	if( (psxHu32(0x1070) & psxHu32(0x1074)) == 0 ) return;
 
-	if( !eeEventTestIsActive )
+	if( THREAD_IOP && iopThread.IsSelf() )
+	{
+		// The threaded IOP runs its own timeslices, so it only has to branch to the
+		// interrupt itself; the EE's event scheduler is the EE thread's business.
+		if( !iopEventTestIsActive )
+			psxSetNextBranchDelta( 2 );
+	}
+	else if( !eeEventTestIsActive )
 	{
 		// An iop exception has occurred while the EE is running code.
 		// Inform the EE to branch so the IOP can handle it promptly:
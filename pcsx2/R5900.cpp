@@ -22,6 +22,7 @@
 #include "VUmicro.h"
 #include "COP0.h"
 #include "MTVU.h"
+#include "MTIOP.h"
 
 #include "System/SysThreads.h"
 #include "R5900Exceptions.h"
@@ -56,6 +57,7 @@ extern SysMainMemory& GetVmMemory();
 void cpuReset()
 {
 	vu1Thread.WaitVU();
+	iopThread.WaitIOP();
 	if (GetMTGS().IsOpen())
 		GetMTGS().WaitGS();		// GS better be done processing before we reset the EE, just in case.
 
@@ -65,6 +67,8 @@ void cpuReset()
 	memzero(fpuRegs);
 	memzero(tlb);
 
+	eeEventQueue.Reset();
+
 	cpuRegs.pc				= 0xbfc00000; //set pc reg to stack
 	cpuRegs.CP0.n.Config	= 0x440;
 	cpuRegs.CP0.n.Status.val= 0x70400004; //0x10900000 <-- wrong; // COP0 enabled | BEV = 1 | TS = 1
@@ -258,17 +262,141 @@ __fi void cpuClearInt( uint i )
 	cpuRegs.interrupt &= ~(1 << i);
 }
 
-static __fi void TESTINT( u8 n, void (*callback)() )
+// --------------------------------------------------------------------------------------
+//  CycleEventQueue  (implementations)
+// --------------------------------------------------------------------------------------
+
+// signed difference so that the ordering survives the cycle counter wrapping around.
+static __fi bool cycleBefore( u32 a, u32 b )
+{
+	return (s32)(a - b) < 0;
+}
+
+void CycleEventQueue::Push( uint id, u32 due )
+{
+	uint i = m_count++;
+
+	while( i > 0 )
+	{
+		uint parent = (i - 1) / 2;
+		if( !cycleBefore( due, m_heap[parent].due ) ) break;
+
+		m_heap[i] = m_heap[parent];
+		i = parent;
+	}
+
+	m_heap[i].due	= due;
+	m_heap[i].id	= id;
+
+	m_queued |= 1 << id;
+}
+
+void CycleEventQueue::Pop()
+{
+	const Entry last = m_heap[--m_count];
+	uint i = 0;
+
+	while( true )
+	{
+		uint child = i * 2 + 1;
+		if( child >= m_count ) break;
+
+		if( (child + 1 < m_count) && cycleBefore( m_heap[child + 1].due, m_heap[child].due ) ) ++child;
+		if( !cycleBefore( m_heap[child].due, last.due ) ) break;
+
+		m_heap[i] = m_heap[child];
+		i = child;
+	}
+
+	m_heap[i] = last;
+}
+
+void CycleEventQueue::Schedule( uint id, u32 due )
+{
+	if( !(m_events & (1 << id)) ) return;
+
+	// A full heap (lots of rethrown events) leaves this one to Update(), which rebuilds it.
+	if( m_count < ArraySize(m_heap) )
+		Push( id, due );
+	else
+		m_queued &= ~(1 << id);
+}
+
+void CycleEventQueue::Update( u32 pending, const u32* sCycle, const u32* eCycle )
+{
+	u32 missing = pending & m_events & ~m_queued;
+	if( !missing ) return;
+
+	if( m_count + 32 > ArraySize(m_heap) )
+	{
+		m_count		= 0;
+		m_queued	= 0;
+		missing		= pending & m_events;
+	}
+
+	for( uint id = 0; missing != 0; ++id, missing >>= 1 )
+	{
+		if( missing & 1 ) Push( id, sCycle[id] + eCycle[id] );
+	}
+}
+
+// Removes the events which are due at the given cycle from the queue and returns their mask.
+u32 CycleEventQueue::PopDue( u32 cycle, u32 pending, const u32* sCycle, const u32* eCycle )
+{
+	u32 due = 0;
+
+	pending &= m_events;
+
+	while( m_count > 0 )
+	{
+		const uint id = m_heap[0].id;
+
+		if( !(pending & (1 << id)) )
+		{
+			// cleared by someone else
+			m_queued &= ~(1 << id);
+			Pop();
+			continue;
+		}
+
+		const u32 at = sCycle[id] + eCycle[id];
+
+		if( at != m_heap[0].due )
+		{
+			// rethrown or postponed since it was queued
+			Pop();
+			Push( id, at );
+			continue;
+		}
+
+		if( cycleBefore( cycle, at ) ) break;
+
+		due |= 1 << id;
+		m_queued &= ~(1 << id);
+		Pop();
+	}
+
+	return due;
+}
+
+CycleEventQueue eeEventQueue(
+	(1 << DMAC_VIF0)		| (1 << DMAC_VIF1)			| (1 << DMAC_GIF)			|
+	(1 << DMAC_FROM_IPU)	| (1 << DMAC_TO_IPU)		| (1 << DMAC_SIF0)			|
+	(1 << DMAC_SIF1)		| (1 << DMAC_FROM_SPR)		| (1 << DMAC_TO_SPR)		|
+	(1 << DMAC_MFIFO_VIF)	| (1 << DMAC_MFIFO_GIF)		| (1 << VIF_VU0_FINISH)		|
+	(1 << VIF_VU1_FINISH)
+);
+
+static __fi void TESTINT( u32 due, u8 n, void (*callback)() )
 {
-	if( !(cpuRegs.interrupt & (1 << n)) ) return;
+	if( !(due & (1 << n)) || !(cpuRegs.interrupt & (1 << n)) ) return;
 
+	// Check the cycle again, an earlier callback may have rethrown the event (which queued it again).
 	if( cpuTestCycle( cpuRegs.sCycle[n], cpuRegs.eCycle[n] ) )
 	{
 		cpuClearInt( n );
 		callback();
 	}
-	else
-		cpuSetNextEvent( cpuRegs.sCycle[n], cpuRegs.eCycle[n] );
 }
 
 // [TODO] move this function to LegacyDmac.cpp, and remove most of the DMAC-related headers from
@@ -283,31 +411,36 @@ static __fi void _cpuTestInterrupts()
 	/* These are 'pcsx2 interrupts', they handle asynchronous stuff
 	   that depends on the cycle timings */
 
-	TESTINT(DMAC_VIF1,		vif1Interrupt);	
-	TESTINT(DMAC_GIF,		gifInterrupt);
-	TESTINT(DMAC_SIF0,		EEsif0Interrupt);
-	TESTINT(DMAC_SIF1,		EEsif1Interrupt);
-	
-	// Profile-guided Optimization (sorta)
-	// The following ints are rarely called.  Encasing them in a conditional
-	// as follows helps speed up most games.
+	eeEventQueue.Update( cpuRegs.interrupt, cpuRegs.sCycle, cpuRegs.eCycle );
 
-	if( cpuRegs.interrupt & 0x60F19 ) // Bits 0 3 4 8 9 10 11 17 18( 1100000111100011001 )
+	const u32 due = eeEventQueue.PopDue( cpuRegs.cycle, cpuRegs.interrupt, cpuRegs.sCycle, cpuRegs.eCycle );
+
+	// Events which are due together are still handled in their traditional order.
+	if( due )
 	{
-		TESTINT(DMAC_VIF0,		vif0Interrupt);
+		TESTINT(due, DMAC_VIF1,			vif1Interrupt);	
+		TESTINT(due, DMAC_GIF,			gifInterrupt);
+		TESTINT(due, DMAC_SIF0,			EEsif0Interrupt);
+		TESTINT(due, DMAC_SIF1,			EEsif1Interrupt);
+
+		TESTINT(due, DMAC_VIF0,			vif0Interrupt);
 
-		TESTINT(DMAC_FROM_IPU,	ipu0Interrupt);
-		TESTINT(DMAC_TO_IPU,	ipu1Interrupt);
+		TESTINT(due, DMAC_FROM_IPU,		ipu0Interrupt);
+		TESTINT(due, DMAC_TO_IPU,		ipu1Interrupt);
 
-		TESTINT(DMAC_FROM_SPR,	SPRFROMinterrupt);
-		TESTINT(DMAC_TO_SPR,	SPRTOinterrupt);
+		TESTINT(due, DMAC_FROM_SPR,		SPRFROMinterrupt);
+		TESTINT(due, DMAC_TO_SPR,		SPRTOinterrupt);
 
-		TESTINT(DMAC_MFIFO_VIF, vifMFIFOInterrupt);
-		TESTINT(DMAC_MFIFO_GIF, gifMFIFOInterrupt);
+		TESTINT(due, DMAC_MFIFO_VIF,	vifMFIFOInterrupt);
+		TESTINT(due, DMAC_MFIFO_GIF,	gifMFIFOInterrupt);
 
-		TESTINT(VIF_VU0_FINISH, vif0VUFinish);
-		TESTINT(VIF_VU1_FINISH, vif1VUFinish);
+		TESTINT(due, VIF_VU0_FINISH,	vif0VUFinish);
+		TESTINT(due, VIF_VU1_FINISH,	vif1VUFinish);
 	}
+
+	u32 next;
+	if( eeEventQueue.GetNext( next ) )
+		cpuSetNextEvent( cpuRegs.cycle, next - cpuRegs.cycle );
 }
 
 static __fi void _cpuTestTIMR()
@@ -358,6 +491,9 @@ u32 g_nextEventCycle = 0;
 // and the recompiler.  (moved here to help alleviate redundant code)
 __fi void _cpuEventTest_Shared()
 {
+	// The threaded IOP must not touch shared state while the EE runs its event test.
+	iopThread.WaitIOP();
+
 	ScopedBool etest(eeEventTestIsActive);
 	g_nextEventCycle = cpuRegs.cycle + eeWaitCycles;
 
@@ -406,16 +542,25 @@ __fi void _cpuEventTest_Shared()
 	if( EEsCycle > 0 )
 		iopEventAction = true;
 
-	iopEventTest();
-
-	if( iopEventAction )
+	if( THREAD_IOP )
+	{
+		// The IOP thread runs its slice (including the iopEventTest) while the EE
+		// carries on; WaitIOP() at the next event test collects the result.
+		iopThread.Launch( EEsCycle );
+	}
+	else
 	{
-		//if( EEsCycle < -450 )
-		//	Console.WriteLn( " IOP ahead by: %d cycles", -EEsCycle );
+		iopEventTest();
+
+		if( iopEventAction )
+		{
+			//if( EEsCycle < -450 )
+			//	Console.WriteLn( " IOP ahead by: %d cycles", -EEsCycle );
 
-		EEsCycle = psxCpu->ExecuteBlock( EEsCycle );
+			EEsCycle = psxCpu->ExecuteBlock( EEsCycle );
 
-		iopEventAction = false;
+			iopEventAction = false;
+		}
 	}
 
 	// ---- VU0 -------------
@@ -429,18 +574,27 @@ __fi void _cpuEventTest_Shared()
 
 	// ---- Schedule Next Event Test --------------
 
-	if( EEsCycle > 192 )
+	if( THREAD_IOP )
 	{
-		// EE's running way ahead of the IOP still, so we should branch quickly to give the
-		// IOP extra timeslices in short order.
-
-		cpuSetNextEventDelta( 48 );
-		//Console.Warning( "EE ahead of the IOP -- Rapid Event!  %d", EEsCycle );
+		// The IOP's position is unknown until its slice completes, so just bound how far
+		// the EE may run before collecting it.
+		cpuSetNextEventDelta( EmuConfig.Speedhacks.IopThreadSlack );
 	}
+	else
+	{
+		if( EEsCycle > 192 )
+		{
+			// EE's running way ahead of the IOP still, so we should branch quickly to give the
+			// IOP extra timeslices in short order.
 
-	// The IOP could be running ahead/behind of us, so adjust the iop's next branch by its
-	// relative position to the EE (via EEsCycle)
-	cpuSetNextEventDelta( ((g_iopNextEventCycle-psxRegs.cycle)*8) - EEsCycle );
+			cpuSetNextEventDelta( 48 );
+			//Console.Warning( "EE ahead of the IOP -- Rapid Event!  %d", EEsCycle );
+		}
+
+		// The IOP could be running ahead/behind of us, so adjust the iop's next branch by its
+		// relative position to the EE (via EEsCycle)
+		cpuSetNextEventDelta( ((g_iopNextEventCycle-psxRegs.cycle)*8) - EEsCycle );
+	}
 
 	// Apply the hsync counter's nextCycle
 	cpuSetNextEvent( hsyncCounter.sCycle, hsyncCounter.CycleT );
@@ -458,7 +612,7 @@ __ri void cpuTestINTCInts()
 	if( (psHu32(INTC_STAT) & psHu32(INTC_MASK)) == 0 ) return;
 
 	cpuSetNextEventDelta( 4 );
-	if(eeEventTestIsActive && (iopCycleEE > 0))
+	if(eeEventTestIsActive && (iopCycleEE > 0) && (!THREAD_IOP || iopThread.IsSelf()))
 	{
 		iopBreak += iopCycleEE;		// record the number of cycles the IOP didn't run.
 		iopCycleEE = 0;
@@ -475,7 +629,7 @@ __fi void cpuTestDMACInts()
 		 ( (psHu16(0xe010) & 0x8000) == 0) ) return;
 
 	cpuSetNextEventDelta( 4 );
-	if(eeEventTestIsActive && (iopCycleEE > 0))
+	if(eeEventTestIsActive && (iopCycleEE > 0) && (!THREAD_IOP || iopThread.IsSelf()))
 	{
 		iopBreak += iopCycleEE;		// record the number of cycles the IOP didn't run.
 		iopCycleEE = 0;
@@ -510,12 +664,15 @@ __fi void CPU_INT( EE_EventType n, s32 ecycle)
 	cpuRegs.sCycle[n] = cpuRegs.cycle;
 	cpuRegs.eCycle[n] = ecycle;
 
+	eeEventQueue.Schedule( n, cpuRegs.sCycle[n] + cpuRegs.eCycle[n] );
+
 	// Interrupt is happening soon: make sure both EE and IOP are aware.
 
-	if( ecycle <= 28 && iopCycleEE > 0 )
+	if( ecycle <= 28 && iopCycleEE > 0 && (!THREAD_IOP || iopThread.IsSelf()) )
 	{
 		// If running in the IOP, force it to break immediately into the EE.
-		// the EE's branch test is due to run.
+		// the EE's branch test is due to run.  (A threaded IOP is only ever running
+		// here when the EE is parked, so it's only touched from the IOP thread.)
 
 		iopBreak += iopCycleEE;		// record the number of cycles the IOP didn't run.
 		iopCycleEE = 0;
@@ -546,6 +703,15 @@ void __fastcall eeGameStarting()
 // Called from recompilers; __fastcall define is mandatory.
 void __fastcall eeloadReplaceOSDSYS()
 {
+	// The ELF lookups below read the disc through the same CDVD plugin and iso read buffer
+	// as the IOP's CDVD emulation, so park the IOP first (it isn't relaunched until the
+	// EE's next event test).
+	iopThread.WaitIOP();
+
+	// Doesn't return if a snapshot is wanted; the EE comes back here once it's been taken.
+	if (EmuConfig.BootSnapshots && BootSnapshot_IsPending())
+		GetCoreThread().RequestBootSnapshot();
+
 	g_SkipBiosHack = false;
 
 	const wxString &elf_override = GetCoreThread().GetElfOverride();
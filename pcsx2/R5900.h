@@ -411,6 +411,64 @@ enum EE_EventType
 	VIF_VU1_FINISH
 };
 
+// --------------------------------------------------------------------------------------
+//  CycleEventQueue
+// --------------------------------------------------------------------------------------
+// Min-heap of the pending CPU_INT / PSX_INT events, keyed by the absolute cycle they are due
+// on, so that an event test only has to look at the events which are actually due.
+//
+// The interrupt mask and sCycle/eCycle arrays of cpuRegs / psxRegs remain the authoritative
+// (and savestated) event state.  Plenty of code clears interrupt bits or moves eCycle behind
+// our back, so entries are validated when they reach the top of the heap: cleared events are
+// dropped and rescheduled ones are requeued at their new cycle.  Events which are pending but
+// have no entry (heap overflow, loaded savestate) are picked up by Update().
+//
+class CycleEventQueue
+{
+protected:
+	struct Entry
+	{
+		u32 due;
+		u32 id;
+	};
+
+	Entry	m_heap[64];
+	uint	m_count;
+	u32		m_queued;		// events which have an entry in the heap
+	u32		m_events;		// events handled through the queue, other interrupt bits are ignored
+
+public:
+	CycleEventQueue( u32 events )
+		: m_events( events )
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		m_count = 0;
+		m_queued = 0;
+	}
+
+	void Schedule( uint id, u32 due );
+	void Update( u32 pending, const u32* sCycle, const u32* eCycle );
+	u32 PopDue( u32 cycle, u32 pending, const u32* sCycle, const u32* eCycle );
+
+	// Returns false if no event is queued.
+	bool GetNext( u32& due ) const
+	{
+		if( m_count == 0 ) return false;
+		due = m_heap[0].due;
+		return true;
+	}
+
+protected:
+	void Push( uint id, u32 due );
+	void Pop();
+};
+
+extern CycleEventQueue eeEventQueue;
+
 extern void CPU_INT( EE_EventType n, s32 ecycle );
 extern uint intcInterrupt();
 extern uint dmacInterrupt();
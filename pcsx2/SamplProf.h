@@ -18,8 +18,9 @@
 
 #include "Common.h"
 
-// The profiler does not have a Linux version yet.
-// So for now we turn it into duds for non-Win32 platforms.
+// The sampling profiler does not have a Linux version yet.
+// So for now we turn it into duds for non-Win32 platforms; on Linux the recompilers
+// instead name their blocks for perf (see ProfilerRegisterBlock).
 
 #ifdef WIN32
 
@@ -34,6 +35,8 @@ void ProfilerRegisterSource(const wxString& Name, const void* buff, u32 sz);
 void ProfilerRegisterSource(const wxString& Name, const void* function);
 void ProfilerTerminateSource( const wxString& Name );
 
+#define ProfilerRegisterBlock 0&&
+
 #else
 
 // Disables the profiler in Debug & Linux builds.
@@ -46,6 +49,46 @@ void ProfilerTerminateSource( const wxString& Name );
 #define ProfilerRegisterSource 0&&
 #define ProfilerTerminateSource 0&&
 
+#ifdef __LINUX__
+// Names a block of recompiled code for perf and other tools that read /tmp/perf-<pid>.map.
+// Callers check EmuConfig.Profiler first, so nothing is written unless it's enabled.
+void ProfilerRegisterBlock(const void* code, u32 size, const char* fmt, ...);
+#else
+#define ProfilerRegisterBlock 0&&
 #endif
 
 #endif
+
+// --------------------------------------------------------------------------------------
+//  Guest profiler  (DebugTools/GuestProfiler.cpp)
+// --------------------------------------------------------------------------------------
+// Periodically samples the guest PCs of the EE, IOP and VUs while the VM runs, and writes
+// a report of the hottest game functions and blocks per game (logs/GuestProfile_<crc>.txt).
+// Enabled by Profiler.Enabled together with Profiler.GuestSamples.
+
+// What the EE thread is doing, beyond running recompiled code.  Only kept up to date while
+// the guest profiler is enabled (the dispatchers only store it when generated for it);
+// event tests are told apart by eeEventTestIsActive instead.
+enum GuestProfileZone
+{
+	GPZ_Code = 0,		// recompiled code (and the interpreter)
+	GPZ_Dispatcher,		// block lookup in the EE dispatchers
+	GPZ_Memory,			// vtlb indirect memory handlers
+	GPZ_Recompiler,		// recompiling a block
+	GPZ_EventTest,
+
+	GPZ_Count
+};
+
+extern volatile u8 g_eeProfileZone;
+
+static __fi bool GuestProfiler_IsEnabled()
+{
+	return EmuConfig.Profiler.Enabled && EmuConfig.Profiler.GuestSamples;
+}
+
+extern void GuestProfiler_Resume();
+extern void GuestProfiler_Suspend();
+extern void GuestProfiler_Flush();
+
+#endif
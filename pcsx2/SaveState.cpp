@@ -22,13 +22,18 @@
 #include "COP0.h"
 #include "VUmicro.h"
 #include "MTVU.h"
+#include "MTIOP.h"
 #include "Cache.h"
 #include "AppConfig.h"
 
 #include "Elfheader.h"
 #include "Counters.h"
+#include "CDVD/CDVD.h"
 
 #include "Utilities/SafeArray.inl"
+#include "Utilities/HashMap.h"
+
+#include <wx/ffile.h>
 
 using namespace R5900;
 
@@ -44,6 +49,10 @@ static void PostLoadPrep()
 //	WriteCP0Status(cpuRegs.CP0.n.Status.val);
 	for(int i=0; i<48; i++) MapTLB(i);
 
+	// queued events are keyed by the cycles of the old state, Update() requeues the loaded ones.
+	eeEventQueue.Reset();
+	iopEventQueue.Reset();
+
 	UpdateVSyncRate();
 }
 
@@ -152,6 +161,7 @@ static const uint MainMemorySizeInBytes =
 SaveStateBase& SaveStateBase::FreezeMainMemory()
 {
 	vu1Thread.WaitVU(); // Finish VU1 just in-case...
+	iopThread.WaitIOP();
 	if (IsLoading()) PreLoadPrep();
 	else m_memory->MakeRoomFor( m_idx + MainMemorySizeInBytes );
 
@@ -176,6 +186,7 @@ SaveStateBase& SaveStateBase::FreezeMainMemory()
 SaveStateBase& SaveStateBase::FreezeInternals()
 {
 	vu1Thread.WaitVU(); // Finish VU1 just in-case...
+	iopThread.WaitIOP();
 	// Print this until the MTVU problem in gifPathFreeze is taken care of (rama)
 	if (THREAD_VU1) Console.Warning("MTVU speedhack is enabled, saved states may not be stable");
 	
@@ -324,6 +335,180 @@ void memLoadingState::FreezeMem( void* data, int size )
 	memcpy_fast( data, src, size );
 }
 
+// --------------------------------------------------------------------------------------
+//  Boot Snapshots  (EmuConfig.BootSnapshots)
+// --------------------------------------------------------------------------------------
+// With fast boot, the BIOS runs from reset until the EE reaches EELOAD, where
+// eeloadReplaceOSDSYS points it at the game instead of OSDSYS.  Nothing up to that point
+// depends on the game, so the full VM state there is captured once and loaded straight
+// after later resets, skipping the BIOS boot entirely.
+//
+// Snapshots are keyed by everything that can change what the BIOS boot produces: the BIOS
+// itself, the savestate format, the cpu/speedhack/gamefix settings, the plugins (whose
+// freeze data is part of the state), and the kind of disc in the drive.
+
+static const u32 BootSnapshot_Magic = 0x544f4f42;		// "BOOT"
+
+struct BootSnapshotHeader
+{
+	u32		magic;
+	u32		key;
+	u32		version;
+	u32		size;
+};
+
+// Set when this boot was restored from a snapshot or has already been captured, so that
+// reaching EELOAD (again) doesn't capture it all over again.
+static bool s_BootSnapshotDone = false;
+
+static u32 BootSnapshot_GetKey()
+{
+	wxString key( pxsFmt( L"%s|%08X|%08X|%d|%d|%d|%d",
+		BiosDescription.c_str(), BiosChecksum, g_SaveVersion,
+		CDVDsys_GetSourceType(), DoCDVDdetectDiskType(),
+		EmuConfig.MultitapPort0_Enabled, EmuConfig.MultitapPort1_Enabled
+	) );
+
+	for (uint i=0; i<PluginId_Count; ++i)
+		key += L"|" + GetCorePlugins().GetName( (PluginsEnum_t)i );
+
+	const u32 settings[] =
+	{
+		EmuConfig.Cpu.Recompiler.bitset,
+		EmuConfig.Cpu.sseMXCSR.bitmask,
+		EmuConfig.Cpu.sseVUMXCSR.bitmask,
+		EmuConfig.Speedhacks.bitset,
+		EmuConfig.Speedhacks.EECycleRate,
+		EmuConfig.Speedhacks.VUCycleSteal,
+		EmuConfig.Speedhacks.IopThreadSlack,
+		EmuConfig.Gamefixes.bitset,
+	};
+
+	return HashTools::Hash( (const char*)key.wc_str(), key.Length() * sizeof(wxChar) )
+		^ HashTools::Hash( (const char*)settings, sizeof(settings) );
+}
+
+static wxString BootSnapshot_GetFilename( u32 key )
+{
+	return (g_Conf->Folders.Savestates + pxsFmt( L"BootSnapshot-%08X.bin", key )).GetFullPath();
+}
+
+// Loads the boot snapshot matching the current configuration, if there is one.  Called on
+// the core thread right after a cpu reset, with plugins open.  Returns false if the BIOS
+// has to be booted normally.
+bool BootSnapshot_Restore()
+{
+	s_BootSnapshotDone = false;
+	if (!EmuConfig.UseBOOT2Injection) return false;
+
+	const u32 key = BootSnapshot_GetKey();
+	const wxString filename( BootSnapshot_GetFilename( key ) );
+	if (!wxFileExists( filename )) return false;
+
+	wxFFile fp( filename, L"rb" );
+	BootSnapshotHeader header;
+	if (!fp.IsOpened() || fp.Read( &header, sizeof(header) ) != sizeof(header)) return false;
+
+	if (header.magic != BootSnapshot_Magic || header.key != key || header.version != g_SaveVersion)
+	{
+		Console.Warning( L"(BootSnapshot) Ignoring stale snapshot: " + filename );
+		return false;
+	}
+
+	ScopedPtr<VmStateBuffer> buffer( new VmStateBuffer( header.size, L"BootSnapshot" ) );
+	if (fp.Read( buffer->GetPtr(), header.size ) != header.size) return false;
+
+	// The RTC was seeded from the host clock by the reset; keep it, rather than travelling
+	// back to the time the snapshot was taken.
+	const cdvdRTC rtc = cdvd.RTC;
+
+	try {
+		memLoadingState( buffer ).FreezeAll();
+	}
+	catch (BaseException& ex)
+	{
+		Console.Error( L"(BootSnapshot) Failed to load %s: %s", filename.c_str(), ex.FormatDiagnosticMessage().c_str() );
+
+		// Whatever got loaded is unusable, plugin state included; reopen the plugins and
+		// boot the BIOS from scratch instead.
+		GetCorePlugins().Close();
+		GetCorePlugins().Open();
+		cpuReset();
+		return false;
+	}
+
+	cdvd.RTC = rtc;
+	s_BootSnapshotDone = true;
+
+	Console.WriteLn( Color_Green, L"(BootSnapshot) Skipped BIOS boot using " + filename );
+	return true;
+}
+
+// Checks whether the state at EELOAD should be captured: not if this boot was itself
+// restored from a snapshot (or already captured), or a matching snapshot already exists.
+// Called on the EE thread from eeloadReplaceOSDSYS, before it has touched anything.
+bool BootSnapshot_IsPending()
+{
+	if (s_BootSnapshotDone) return false;
+
+	if (wxFileExists( BootSnapshot_GetFilename( BootSnapshot_GetKey() ) ))
+	{
+		s_BootSnapshotDone = true;
+		return false;
+	}
+
+	return true;
+}
+
+// Saves a boot snapshot.  Called on the core thread from StateCheckInThread, with the EE
+// stopped at EELOAD (see SysCoreThread::RequestBootSnapshot).
+void BootSnapshot_Capture()
+{
+	// Only one attempt per boot; a failed capture isn't retried.
+	s_BootSnapshotDone = true;
+
+	const u32 key = BootSnapshot_GetKey();
+	const wxString filename( BootSnapshot_GetFilename( key ) );
+	if (wxFileExists( filename )) return;
+
+	try {
+		ScopedPtr<VmStateBuffer> buffer( new VmStateBuffer( L"BootSnapshot" ) );
+		memSavingState saveme( buffer );
+		saveme.FreezeAll();
+
+		BootSnapshotHeader header;
+		header.magic	= BootSnapshot_Magic;
+		header.key		= key;
+		header.version	= g_SaveVersion;
+		header.size		= saveme.GetCurrentPos();
+
+		// Written under a temporary name and renamed into place, so that several instances
+		// booting at once never see a partial snapshot.
+		const wxString tempname( filename + pxsFmt( L".%u.tmp", (uint)wxGetProcessId() ) );
+		{
+			wxFFile fp( tempname, L"wb" );
+			if (!fp.IsOpened()
+				|| fp.Write( &header, sizeof(header) ) != sizeof(header)
+				|| fp.Write( buffer->GetPtr(), header.size ) != header.size
+				|| !fp.Close())
+			{
+				Console.Warning( L"(BootSnapshot) Could not write " + tempname );
+				wxRemoveFile( tempname );
+				return;
+			}
+		}
+
+		if (!wxRenameFile( tempname, filename, false ))
+			wxRemoveFile( tempname );
+		else
+			Console.WriteLn( Color_Green, L"(BootSnapshot) Saved " + filename );
+	}
+	catch (BaseException& ex)
+	{
+		Console.Warning( L"(BootSnapshot) Capture failed: " + ex.FormatDiagnosticMessage() );
+	}
+}
+
 // --------------------------------------------------------------------------------------
 //  SaveState Exception Messages
 // --------------------------------------------------------------------------------------
@@ -30,6 +30,12 @@ static const u32 g_SaveVersion = (0x9A0A << 16) | 0x0000;
 // between the GS saving function and the MTGS's needs. :)
 extern s32 CALLBACK gsSafeFreeze( int mode, freezeData *data );
 
+// Boot snapshots: VM state captured at EELOAD during a fast boot, and restored on later
+// resets to skip the BIOS boot (see SaveState.cpp).
+extern bool BootSnapshot_Restore();
+extern bool BootSnapshot_IsPending();
+extern void BootSnapshot_Capture();
+
 
 namespace Exception
 {
@@ -26,9 +26,28 @@ void sifInit()
 	memzero(sif1);
 }
 
+// Returns a host pointer for a SIF transfer to/from EE memory at madr, along with the number
+// of quadwords that can be moved through it in one go (up to the end of main memory or the
+// scratchpad).  Returns NULL for anything that isn't plain memory, in which case the transfer
+// has to go through the fifo and dmaGetAddr.
+u8* sifGetDirectAddr(u32 madr, u32& maxqwc)
+{
+	if (DMA_TAG(madr).SPR)
+	{
+		maxqwc = (Ps2MemSize::Scratch - (madr & 0x3ff0)) >> 4;
+		return &eeMem->Scratch[madr & 0x3ff0];
+	}
+
+	madr &= 0x1ffffff0;
+	if (madr >= Ps2MemSize::MainRam) return NULL;
+
+	maxqwc = (Ps2MemSize::MainRam - madr) >> 4;
+	return &eeMem->Main[madr];
+}
+
 __fi void dmaSIF2()
 {
-	SIF_LOG(wxString(L"dmaSIF2" + sif2dma.cmq_to_str()).To8BitData());
+	SIF_LOG("%s", (const char*)wxString(L"dmaSIF2" + sif2dma.cmq_to_str()).To8BitData());
 
 	sif2dma.chcr.STR = false;
 	hwDmacIrq(DMAC_SIF2);
@@ -126,6 +126,7 @@ struct _sif
 extern _sif sif0, sif1;
 
 extern void sifInit();
+extern u8* sifGetDirectAddr(u32 madr, u32& maxqwc);
 
 extern void SIF0Dma();
 extern void SIF1Dma();
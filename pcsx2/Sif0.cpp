@@ -79,6 +79,38 @@ static __fi bool WriteIOPtoFifo()
 	return true;
 }
 
+// Copy straight from IOP to EE memory, skipping the fifo.  Only done while the fifo is empty
+// and both sides are in the middle of a block, and only in whole quadwords, so the cycle
+// counts (and the fifo state afterwards) come out exactly as if the data had gone through
+// the fifo a chunk at a time.
+static __fi bool TransferDirect()
+{
+	if (sif0.fifo.size != 0 || !sif0dma.chcr.STR) return false;
+
+	u32 maxqwc;
+	u8* dest = sifGetDirectAddr(sif0dma.madr, maxqwc);
+	if (dest == NULL) return false;
+
+	const u32 iopmadr = hw_dma9.madr & 0x1ffffc;
+	int words = min(sif0.iop.counter, (s32)min((u32)sif0dma.qwc, maxqwc) << 2);
+	words = min(words, (s32)(Ps2MemSize::IopRam - iopmadr) >> 2) & ~3;
+	if (words <= 0) return false;
+
+	SIF_LOG("SIF0 direct IOP %08X -> EE %08X: %X words", iopmadr, sif0dma.madr, words);
+
+	memcpy_fast(dest, iopPhysMem(iopmadr), words << 2);
+
+	hw_dma9.madr += words << 2;
+	sif0.iop.cycles += words >> 2;
+	sif0.iop.counter -= words;
+
+	sif0dma.madr += words << 2;
+	sif0.ee.cycles += words >> 2;
+	sif0dma.qwc -= words >> 2;
+
+	return true;
+}
+
 // Read Fifo into an ee tag, transfer it to sif0dma, and process it.
 static __fi bool ProcessEETag()
 {
@@ -302,6 +334,11 @@ __fi void SIF0Dma()
 		//I realise this is very hacky in a way but its an easy way of checking if both are doing something
 		BusyCheck = 0;
 
+		if (sif0.iop.busy && sif0.ee.busy && sif0.iop.counter > 0 && sif0dma.qwc > 0)
+		{
+			if (TransferDirect()) BusyCheck++;
+		}
+
 		if (sif0.iop.busy)
 		{
 			if(sif0.fifo.sif_free() > 0 || (sif0.iop.end == true && sif0.iop.counter == 0)) 
@@ -337,7 +374,7 @@ __fi void  EEsif0Interrupt()
 
 __fi void dmaSIF0()
 {
-	SIF_LOG(wxString(L"dmaSIF0" + sif0dma.cmqt_to_str()).To8BitData());
+	SIF_LOG("%s", (const char*)wxString(L"dmaSIF0" + sif0dma.cmqt_to_str()).To8BitData());
 
 	if (sif0.fifo.readPos != sif0.fifo.writePos)
 	{
@@ -78,6 +78,39 @@ static __fi bool WriteFifoToIOP()
 	return true;
 }
 
+// Copy straight from EE to IOP memory, skipping the fifo.  Same rules as SIF0's direct path:
+// the fifo must be empty, and only whole quadwords are moved, so the cycle counts match the
+// chunked transfer exactly.
+static __fi bool TransferDirect()
+{
+	if (sif1.fifo.size != 0 || !sif1dma.chcr.STR) return false;
+
+	u32 maxqwc;
+	const u8* src = sifGetDirectAddr(sif1dma.madr, maxqwc);
+	if (src == NULL) return false;
+
+	const u32 iopmadr = hw_dma10.madr & 0x1ffffc;
+	int words = min(sif1.iop.counter, (s32)min((u32)sif1dma.qwc, maxqwc) << 2);
+	words = min(words, (s32)(Ps2MemSize::IopRam - iopmadr) >> 2) & ~3;
+	if (words <= 0) return false;
+
+	SIF_LOG("SIF1 direct EE %08X -> IOP %08X: %X words", sif1dma.madr, iopmadr, words);
+
+	memcpy_fast(iopPhysMem(iopmadr), src, words << 2);
+	psxCpu->Clear(iopmadr, words);
+
+	sif1dma.madr += words << 2;
+	hwDmacSrcTadrInc(sif1dma);
+	sif1.ee.cycles += words >> 2;
+	sif1dma.qwc -= words >> 2;
+
+	hw_dma10.madr += words << 2;
+	sif1.iop.cycles += words >> 2;
+	sif1.iop.counter -= words;
+
+	return true;
+}
+
 // Get a tag and process it.
 static __fi bool ProcessEETag()
 {
@@ -105,7 +138,7 @@ static __fi bool ProcessEETag()
 		sif1.ee.end = true;
 	}
 
-	SIF_LOG(wxString(ptag->tag_to_str()).To8BitData());
+	SIF_LOG("%s", (const char*)wxString(ptag->tag_to_str()).To8BitData());
 	switch (ptag->ID)
 	{
 		case TAG_REFE:
@@ -295,6 +328,11 @@ __fi void SIF1Dma()
 		//I realise this is very hacky in a way but its an easy way of checking if both are doing something
 		BusyCheck = 0;
 
+		if (sif1.ee.busy && sif1.iop.busy && sif1.iop.counter > 0 && sif1dma.qwc > 0)
+		{
+			if (TransferDirect()) BusyCheck++;
+		}
+
 		if (sif1.ee.busy)
 		{
 			if(sif1.fifo.sif_free() > 0 || (sif1.ee.end == true && sif1dma.qwc == 0)) 
@@ -334,7 +372,7 @@ __fi void  EEsif1Interrupt()
 // Main difference is this checks for iop, where psxDma10 checks for ee.
 __fi void dmaSIF1()
 {
-	SIF_LOG(wxString(L"dmaSIF1" + sif1dma.cmqt_to_str()).To8BitData());
+	SIF_LOG("%s", (const char*)wxString(L"dmaSIF1" + sif1dma.cmqt_to_str()).To8BitData());
 
 	if (sif1.fifo.readPos != sif1.fifo.writePos)
 	{
@@ -86,6 +86,39 @@ void SysTraceLog_VIFcode::ApplyPrefix( FastFormatAscii& ascii ) const
 	ascii.Write( "vifCode_" );
 }
 
+void SysTraceLog_EE::GetTraceContext( u32& pc, u32& cycle ) const
+{
+	pc		= cpuRegs.pc;
+	cycle	= cpuRegs.cycle;
+}
+
+bool SysTraceLog_EE::GetTracePrefix( const char*& name, const char*& suffix ) const
+{
+	name	= ((SysTraceLogDescriptor*)m_Descriptor)->Prefix;
+	suffix	= "";
+	return true;
+}
+
+void SysTraceLog_IOP::GetTraceContext( u32& pc, u32& cycle ) const
+{
+	pc		= psxRegs.pc;
+	cycle	= psxRegs.cycle;
+}
+
+bool SysTraceLog_IOP::GetTracePrefix( const char*& name, const char*& suffix ) const
+{
+	name	= ((SysTraceLogDescriptor*)m_Descriptor)->Prefix;
+	suffix	= "";
+	return true;
+}
+
+bool SysTraceLog_VIFcode::GetTracePrefix( const char*& name, const char*& suffix ) const
+{
+	_parent::GetTracePrefix( name, suffix );
+	suffix	= "vifCode_";
+	return true;
+}
+
 // --------------------------------------------------------------------------------------
 //  SysConsoleLogPack  (descriptions)
 // --------------------------------------------------------------------------------------
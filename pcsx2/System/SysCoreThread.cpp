@@ -24,6 +24,8 @@
 #include "Patch.h"
 #include "SysThreads.h"
 #include "MTVU.h"
+#include "MTIOP.h"
+#include "SamplProf.h"
 
 #include "Utilities/PageFaultSource.h"
 #include "Utilities/TlsVariable.inl"
@@ -48,6 +50,7 @@ SysCoreThread::SysCoreThread()
 	m_resetVirtualMachine	= true;
 
 	m_hasActiveMachine		= false;
+	m_bootSnapshotPending	= false;
 }
 
 SysCoreThread::~SysCoreThread() throw()
@@ -162,7 +165,16 @@ void SysCoreThread::UploadStateCopy( const VmStateBuffer& copy )
 // --------------------------------------------------------------------------------------
 bool SysCoreThread::HasPendingStateChangeRequest() const
 {
-	return !m_hasActiveMachine || GetMTGS().HasPendingException() || _parent::HasPendingStateChangeRequest();
+	return !m_hasActiveMachine || m_bootSnapshotPending || GetMTGS().HasPendingException() || _parent::HasPendingStateChangeRequest();
+}
+
+// Called on the EE thread (from eeloadReplaceOSDSYS) when a boot snapshot is wanted.  The
+// plugins can't be frozen from there, so execution is stopped and the snapshot is taken
+// by StateCheckInThread; the EE then resumes at EELOAD and carries on with the boot.
+void SysCoreThread::RequestBootSnapshot()
+{
+	m_bootSnapshotPending = true;
+	Cpu->CheckExecutionState();
 }
 
 void SysCoreThread::_reset_stuff_as_needed()
@@ -185,7 +197,9 @@ void SysCoreThread::_reset_stuff_as_needed()
 
 	if( m_resetVirtualMachine )
 	{
+		GuestProfiler_Flush();
 		DoCpuReset();
+		if( EmuConfig.BootSnapshots ) BootSnapshot_Restore();
 
 		m_resetVirtualMachine	= false;
 		m_resetVsyncTimers		= false;
@@ -224,6 +238,7 @@ void SysCoreThread::VsyncInThread()
 void SysCoreThread::GameStartingInThread()
 {
 	GetMTGS().SendGameCRC(ElfCRC);
+	GuestProfiler_Flush();
 
 	if (EmuConfig.EnablePatches) ApplyPatch(0);
 	if (EmuConfig.EnableCheats)  ApplyCheat(0);
@@ -232,7 +247,22 @@ void SysCoreThread::GameStartingInThread()
 bool SysCoreThread::StateCheckInThread()
 {
 	GetMTGS().RethrowException();
-	return _parent::StateCheckInThread() && (_reset_stuff_as_needed(), true);
+	if( !_parent::StateCheckInThread() ) return false;
+
+	if( m_bootSnapshotPending )
+	{
+		m_bootSnapshotPending = false;
+
+		// A pending VM reset means the boot being captured is about to be thrown away.
+		if( !m_resetVirtualMachine )
+		{
+			vu1Thread.WaitVU();
+			BootSnapshot_Capture();
+		}
+	}
+
+	_reset_stuff_as_needed();
+	return true;
 }
 
 // Runs CPU cycles indefinitely, until the user or another thread requests execution to break.
@@ -243,6 +273,7 @@ void SysCoreThread::DoCpuExecute()
 	m_hasActiveMachine = true;
 	UI_EnableSysActions();
 	Cpu->Execute();
+	iopThread.WaitIOP();
 }
 
 void SysCoreThread::ExecuteTaskInThread()
@@ -262,12 +293,14 @@ void SysCoreThread::ExecuteTaskInThread()
 
 void SysCoreThread::OnSuspendInThread()
 {
+	GuestProfiler_Suspend();
 	GetCorePlugins().Close();
 }
 
 void SysCoreThread::OnResumeInThread( bool isSuspended )
 {
 	GetCorePlugins().Open();
+	GuestProfiler_Resume();
 }
 
 
@@ -281,6 +314,9 @@ void SysCoreThread::OnCleanupInThread()
 
 	// FIXME: temporary workaround for deadlock on exit, which actually should be a crash
 	vu1Thread.WaitVU();
+	iopThread.WaitIOP();
+	GuestProfiler_Suspend();
+	GuestProfiler_Flush();
 	GetCorePlugins().Close();
 	GetCorePlugins().Shutdown();
 
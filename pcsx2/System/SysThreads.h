@@ -172,6 +172,10 @@ protected:
 	// occurs while trying to upload a new state into the VM.
 	volatile bool	m_hasActiveMachine;
 
+	// Set by the EE when it reaches EELOAD and a boot snapshot should be captured there;
+	// execution stops so that StateCheckInThread can capture it.
+	volatile bool	m_bootSnapshotPending;
+
 	wxString		m_elf_override;
 	
 	SSE_MXCSR		m_mxcsr_saved;
@@ -199,6 +203,8 @@ public:
 	
 	virtual const wxString& GetElfOverride() const { return m_elf_override; }
 	virtual void SetElfOverride( const wxString& elf );
+
+	void RequestBootSnapshot();
 	
 protected:
 	void _reset_stuff_as_needed();
@@ -297,6 +297,8 @@ static __fi void _vifCode_MPG(int idx, u32 addr, const u32 *data, int size) {
 		
 		memcpy_fast(VUx.Micro + addr, data, (idx ? 0x4000 : 0x1000) - addr);
 		size -= ((idx ? 0x4000 : 0x1000) - addr) / 4;
+		if (!idx)  CpuVU0->Clear(0, size*4);
+		else	   CpuVU1->Clear(0, size*4);
 		memcpy_fast(VUx.Micro, data, size);
 
 		vifX.tag.addr = size * 4;
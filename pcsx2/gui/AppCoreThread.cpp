@@ -254,6 +254,13 @@ static int loadGameSettings(Pcsx2Config& dest, const Game_Data& game, bool verbo
 		gf++;
 	}
 
+	if (game.keyExists("mvuOptTier")) {
+		bool vuOptTier = game.getInt("mvuOptTier") ? 1 : 0;
+		if(verbose) Console.WriteLn("(GameDB) Changing mVU optimization tier [mode=%d]", vuOptTier);
+		dest.Speedhacks.vuOptTier = vuOptTier;
+		gf++;
+	}
+
 	for( GamefixId id=GamefixId_FIRST; id<pxEnumEnd; ++id )
 	{
 		wxString key( EnumToString(id) );
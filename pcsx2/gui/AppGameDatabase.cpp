@@ -17,6 +17,8 @@
 #include "App.h"
 #include "AppGameDatabase.h"
 #include <wx/stdpaths.h>
+#include <wx/mstream.h>
+#include <algorithm>
 
 class DBLoaderHelper
 {
@@ -146,6 +148,262 @@ void DBLoaderHelper::ReadGames()
 	}
 }
 
+// --------------------------------------------------------------------------------------
+//  Compiled GameIndex
+// --------------------------------------------------------------------------------------
+// Parsing all of GameIndex.dbf takes a good while, and almost every game in it is never looked
+// at, so the first load writes a compiled copy: the header text, then each game's lines as one
+// UTF-8 block, and a table of serials sorted for binary search.  Later runs map that file and
+// only parse the blocks of games that actually get looked up.  The compiled copy is tied to
+// the size and timestamp of the dbf it came from, and is rebuilt whenever those change.
+
+static const u32 GameIndexCompiledVersion = 1;
+
+struct GameIndexCompiledHeader
+{
+	char	magic[4];		// "GIDX"
+	u32		version;
+	u32		filesize;		// catches truncated writes
+	u32		count;			// entries in the serial table
+
+	u64		srcsize;		// size and modification time of the source dbf
+	s64		srctime;
+
+	u32		headerOfs;		// database header text (UTF-8)
+	u32		headerLen;
+	u32		tableOfs;		// GameIndexCompiledEntry[count], sorted by serial
+};
+
+struct GameIndexCompiledEntry
+{
+	u32		serialOfs;		// upper-cased serial (UTF-8)
+	u32		serialLen;
+	u32		dataOfs;		// the game's lines, exactly as SaveToFile would write them
+	u32		dataLen;
+};
+
+// Orders the same way as std::string, which is what SaveCompiled sorts with.
+static int GameIndexCompareSerial( const u8* base, const GameIndexCompiledEntry& entry, const std::string& key )
+{
+	int result = memcmp( base + entry.serialOfs, key.data(), std::min<size_t>(entry.serialLen, key.length()) );
+	if( result ) return result;
+	return (int)entry.serialLen - (int)key.length();
+}
+
+static std::string GameIndexSerialKey( const wxString& id )
+{
+	return std::string( id.Upper().ToUTF8() );
+}
+
+bool AppGameDatabase::LoadCompiled( const wxString& srcfile, const wxString& dbcfile )
+{
+	if( !wxFileExists(dbcfile) ) return false;
+
+	size_t size = 0;
+	const u8* data = (const u8*)HostSys::MmapFile( dbcfile, size );
+	if( !data ) return false;
+
+	const GameIndexCompiledHeader& hdr( *(const GameIndexCompiledHeader*)data );
+	wxFileName src( srcfile );
+
+	if( (size < sizeof(hdr)) || memcmp(hdr.magic, "GIDX", 4) || (hdr.version != GameIndexCompiledVersion)
+		|| (hdr.filesize != size) || (hdr.srcsize != src.GetSize().GetValue())
+		|| (hdr.srctime != src.GetModificationTime().GetValue().GetValue())
+		|| (hdr.tableOfs + (u64)hdr.count * sizeof(GameIndexCompiledEntry) > size)
+		|| (hdr.headerOfs + (u64)hdr.headerLen > size) )
+	{
+		HostSys::MunmapFile( (void*)data, size );
+		return false;
+	}
+
+	// The file may be damaged (or cut short) in ways the header doesn't show; every entry
+	// has to point inside it before any of them gets used.
+	const GameIndexCompiledEntry* table = (const GameIndexCompiledEntry*)(data + hdr.tableOfs);
+	for( uint i=0; i<hdr.count; ++i )
+	{
+		if( (table[i].serialOfs + (u64)table[i].serialLen > size) || (table[i].dataOfs + (u64)table[i].dataLen > size) )
+		{
+			Console.Warning( L"(GameDB) Ignoring corrupt compiled database [%s]", dbcfile.c_str() );
+			HostSys::MunmapFile( (void*)data, size );
+			return false;
+		}
+	}
+
+	m_compiled		= data;
+	m_compiledSize	= size;
+
+	header = fromUTF8( std::string( (const char*)data + hdr.headerOfs, hdr.headerLen ).c_str() );
+	return true;
+}
+
+void AppGameDatabase::SaveCompiled( const wxString& srcfile, const wxString& dbcfile )
+{
+	typedef std::pair<std::string, std::string> CompiledGame;
+	std::vector<CompiledGame> games;
+
+	for(uint blockidx=0; blockidx<=m_BlockTableWritePos; ++blockidx)
+	{
+		if( !m_BlockTable[blockidx] ) continue;
+
+		const uint endidx = (blockidx == m_BlockTableWritePos) ? m_CurBlockWritePos : m_GamesPerBlock;
+
+		for( uint gameidx=0; gameidx<endidx; ++gameidx )
+		{
+			const Game_Data& game( m_BlockTable[blockidx][gameidx] );
+
+			wxString lines;
+			KeyPairArray::const_iterator i(game.kList.begin());
+			for ( ; i != game.kList.end(); ++i)
+				lines += i->toString();
+
+			games.push_back( CompiledGame(GameIndexSerialKey(game.id), std::string(lines.ToUTF8())) );
+		}
+	}
+
+	std::sort( games.begin(), games.end() );
+
+	std::string headerText( header.ToUTF8() );
+
+	GameIndexCompiledHeader hdr;
+	memzero( hdr );
+	memcpy( hdr.magic, "GIDX", 4 );
+	hdr.version		= GameIndexCompiledVersion;
+	hdr.count		= games.size();
+
+	wxFileName src( srcfile );
+	hdr.srcsize		= src.GetSize().GetValue();
+	hdr.srctime		= src.GetModificationTime().GetValue().GetValue();
+
+	hdr.tableOfs	= sizeof(hdr);
+	hdr.headerOfs	= hdr.tableOfs + games.size() * sizeof(GameIndexCompiledEntry);
+	hdr.headerLen	= headerText.length();
+
+	std::vector<GameIndexCompiledEntry> table( games.size() );
+	u32 pos = hdr.headerOfs + hdr.headerLen;
+
+	for( uint i=0; i<games.size(); ++i )
+	{
+		table[i].serialOfs	= pos;
+		table[i].serialLen	= games[i].first.length();
+		pos += table[i].serialLen;
+
+		table[i].dataOfs	= pos;
+		table[i].dataLen	= games[i].second.length();
+		pos += table[i].dataLen;
+	}
+
+	hdr.filesize = pos;
+
+	// Other instances may have the old file mapped, so it must never be rewritten in place.
+	// Write under a temporary name and rename it over the old one instead.
+	const wxString tempname( dbcfile + pxsFmt( L".%u.tmp", (uint)wxGetProcessId() ) );
+	{
+		wxFFileOutputStream writer( tempname );
+		if( writer.IsOk() )
+		{
+			writer.Write( &hdr, sizeof(hdr) );
+			if( !table.empty() ) writer.Write( &table[0], table.size() * sizeof(GameIndexCompiledEntry) );
+			writer.Write( headerText.data(), headerText.length() );
+
+			for( uint i=0; i<games.size(); ++i )
+			{
+				writer.Write( games[i].first.data(), games[i].first.length() );
+				writer.Write( games[i].second.data(), games[i].second.length() );
+			}
+		}
+
+		if( !writer.IsOk() || !writer.Close() )
+		{
+			Console.Warning( L"(GameDB) Could not write compiled database [%s]", tempname.c_str() );
+			wxRemoveFile( tempname );
+			return;
+		}
+	}
+
+	// Can fail on Windows while another instance has the old file mapped; it gets rebuilt
+	// by a later run then.
+	if( !wxRenameFile( tempname, dbcfile, true ) )
+		wxRemoveFile( tempname );
+}
+
+// Parses a single game out of the compiled database into the hash, if it's in there.
+bool AppGameDatabase::LoadCompiledGame( const wxString& id )
+{
+	const GameIndexCompiledHeader& hdr( *(const GameIndexCompiledHeader*)m_compiled );
+	const GameIndexCompiledEntry* table = (const GameIndexCompiledEntry*)(m_compiled + hdr.tableOfs);
+
+	std::string key( GameIndexSerialKey(id) );
+
+	int lo = 0, hi = hdr.count;
+	while( lo < hi )
+	{
+		int mid = (lo + hi) / 2;
+		int cmp = GameIndexCompareSerial( m_compiled, table[mid], key );
+
+		if( cmp < 0 )
+			lo = mid + 1;
+		else if( cmp > 0 )
+			hi = mid;
+		else
+		{
+			wxMemoryInputStream reader( m_compiled + table[mid].dataOfs, table[mid].dataLen );
+			DBLoaderHelper loader( reader, *this );
+			loader.ReadGames();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Parses every game that hasn't been looked up yet; needed before the database is saved back
+// out as text.
+void AppGameDatabase::LoadAllCompiledGames()
+{
+	if( !m_compiled ) return;
+
+	const GameIndexCompiledHeader& hdr( *(const GameIndexCompiledHeader*)m_compiled );
+	const GameIndexCompiledEntry* table = (const GameIndexCompiledEntry*)(m_compiled + hdr.tableOfs);
+
+	for( uint i=0; i<hdr.count; ++i )
+	{
+		wxMemoryInputStream reader( m_compiled + table[i].dataOfs, table[i].dataLen );
+
+		// Games that were already looked up (and maybe edited) take precedence.
+		wxString line;
+		std::string intermediate;
+		pxReadLine( reader, line, intermediate );
+
+		wxString key, value;
+		if( pxParseAssignmentString( line, key, value ) && (gHash.find(value) != gHash.end()) )
+			continue;
+
+		reader.SeekI( 0 );
+		DBLoaderHelper loader( reader, *this );
+		loader.ReadGames();
+	}
+
+	HostSys::MunmapFile( (void*)m_compiled, m_compiledSize );
+	m_compiled		= NULL;
+	m_compiledSize	= 0;
+}
+
+bool AppGameDatabase::findGame(Game_Data& dest, const wxString& id)
+{
+	ScopedLock lock( m_lock );
+
+	if( m_compiled && (gHash.find(id) == gHash.end()) )
+		LoadCompiledGame( id );
+
+	return BaseGameDatabaseImpl::findGame( dest, id );
+}
+
+void AppGameDatabase::updateGame(const Game_Data& game)
+{
+	ScopedLock lock( m_lock );
+	BaseGameDatabaseImpl::updateGame( game );
+}
+
 // --------------------------------------------------------------------------------------
 //  AppGameDatabase  (implementations)
 // --------------------------------------------------------------------------------------
@@ -176,6 +434,20 @@ AppGameDatabase& AppGameDatabase::LoadFromFile(const wxString& _file, const wxSt
 		return *this;
 	}
 
+	wxString dbcfile( Path::Combine(GetSettingsFolder().ToString(), wxFileName(file).GetName() + L".dbc") );
+
+	u64 qpc_Start = GetCPUTicks();
+
+	if (LoadCompiled(file, dbcfile))
+	{
+		u64 qpc_end = GetCPUTicks();
+
+		Console.WriteLn( "(GameDB) %d games on record (compiled, mapped in %ums)",
+			((const GameIndexCompiledHeader*)m_compiled)->count, (u32)(((qpc_end-qpc_Start)*1000) / GetTickFrequency()) );
+
+		return *this;
+	}
+
 	wxFFileInputStream reader( file );
 
 	if (!reader.IsOk())
@@ -186,7 +458,6 @@ AppGameDatabase& AppGameDatabase::LoadFromFile(const wxString& _file, const wxSt
 
 	DBLoaderHelper loader( reader, *this );
 
-	u64 qpc_Start = GetCPUTicks();
 	header = loader.ReadHeader();
 	loader.ReadGames();
 	u64 qpc_end = GetCPUTicks();
@@ -194,12 +465,17 @@ AppGameDatabase& AppGameDatabase::LoadFromFile(const wxString& _file, const wxSt
 	Console.WriteLn( "(GameDB) %d games on record (loaded in %ums)",
 		gHash.size(), (u32)(((qpc_end-qpc_Start)*1000) / GetTickFrequency()) );
 
+	SaveCompiled( file, dbcfile );
+
 	return *this;
 }
 
 // Saves changes to the database
 
 void AppGameDatabase::SaveToFile(const wxString& file) {
+	ScopedLock lock( m_lock );
+	LoadAllCompiledGames();
+
 	wxFFileOutputStream writer( file );
 	pxWriteMultiline(writer, header);
 
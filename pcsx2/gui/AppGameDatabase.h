@@ -45,12 +45,30 @@ protected:
 	wxString		header;			// Header of the database
 	wxString		baseKey;		// Key to separate games by ("Serial")
 
+	// Compiled form of the database (GameIndex.dbc in the settings folder), mapped read-only.
+	// Games are only parsed out of it when they're first looked up.
+	const u8*		m_compiled;
+	size_t			m_compiledSize;
+
+	// Guards the game hash (and m_compiled) once loaded: the core thread and the GUI's
+	// database panel both look games up, and lookups parse and insert games lazily.
+	Threading::Mutex	m_lock;
+
 public:
-	AppGameDatabase() {}
+	AppGameDatabase()
+	{
+		m_compiled		= NULL;
+		m_compiledSize	= 0;
+	}
+
 	virtual ~AppGameDatabase() throw() {
 		Console.WriteLn( "(GameDB) Unloading..." );
+		HostSys::MunmapFile( (void*)m_compiled, m_compiledSize );
 	}
 
+	bool findGame(Game_Data& dest, const wxString& id);
+	void updateGame(const Game_Data& game);
+
 	// Each linux distributions have his rules for path so we give them the possibility to
 	// change it with compilation flags. -- Gregory
 #ifndef GAMEINDEX_DIR_COMPILATION
@@ -62,6 +80,12 @@ public:
 	AppGameDatabase& LoadFromFile(const wxString& file = Path::Combine( wxString(xGAMEINDEX_str(GAMEINDEX_DIR_COMPILATION), wxConvUTF8) , L"GameIndex.dbf" ), const wxString& key = L"Serial" );
 	void SaveToFile(const wxString& file = Path::Combine( wxString(xGAMEINDEX_str(GAMEINDEX_DIR_COMPILATION), wxConvUTF8) , L"GameIndex.dbf") );
 #endif
+
+protected:
+	bool LoadCompiled( const wxString& srcfile, const wxString& dbcfile );
+	void SaveCompiled( const wxString& srcfile, const wxString& dbcfile );
+	bool LoadCompiledGame( const wxString& id );
+	void LoadAllCompiledGames();
 };
 
 static wxString compatToStringWX(int compat) {
@@ -716,6 +716,7 @@ void Pcsx2App::CleanUp()
 	m_RecentIsoList	= NULL;
 
 	DisableDiskLogging();
+	BinaryTrace_Close();
 
 	if( emuLog != NULL )
 	{
@@ -40,6 +40,12 @@ Panels::McdConfigPanel_Toggles::McdConfigPanel_Toggles(wxWindow *parent)
 		)
 	);
 
+	m_check_BufferedWrites = new pxCheckBox( this,
+		_("Write memory cards in the background"),
+		pxE( L"Keeps memory card contents in memory and writes changes to disk from a background thread.  Avoids stalls in games that save frequently, especially with memory cards on network storage."
+		)
+	);
+
 	//m_check_SavestateBackup = new pxCheckBox( this, pxsFmt(_("Backup existing Savestate when creating a new one")) );
 /*
 	for( uint i=0; i<2; ++i )
@@ -64,6 +70,7 @@ Panels::McdConfigPanel_Toggles::McdConfigPanel_Toggles(wxWindow *parent)
 	*this	+= new wxStaticLine( this )	| StdExpand();
 
 	*this += m_check_Ejection;	
+	*this += m_check_BufferedWrites;
 }
 
 void Panels::McdConfigPanel_Toggles::Apply()
@@ -73,6 +80,7 @@ void Panels::McdConfigPanel_Toggles::Apply()
 
 	//g_Conf->EmuOptions.BackupSavestate			= m_check_SavestateBackup->GetValue();
 	g_Conf->EmuOptions.McdEnableEjection		= m_check_Ejection->GetValue();
+	g_Conf->EmuOptions.McdBufferedWrites		= m_check_BufferedWrites->GetValue();
 }
 
 void Panels::McdConfigPanel_Toggles::AppStatusEvent_OnSettingsApplied()
@@ -82,6 +90,7 @@ void Panels::McdConfigPanel_Toggles::AppStatusEvent_OnSettingsApplied()
 
 	//m_check_SavestateBackup ->SetValue( g_Conf->EmuOptions.BackupSavestate );
 	m_check_Ejection		->SetValue( g_Conf->EmuOptions.McdEnableEjection );
+	m_check_BufferedWrites	->SetValue( g_Conf->EmuOptions.McdBufferedWrites );
 }
 
 
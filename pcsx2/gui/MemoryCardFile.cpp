@@ -35,16 +35,93 @@ struct Component_FileMcd;
 
 #include <wx/ffile.h>
 
+#include "Utilities/PersistentThread.h"
+
+#ifdef _WIN32
+#	include <io.h>
+#else
+#	include <unistd.h>
+#endif
+
+using namespace Threading;
+
 static const int MCD_SIZE	= 1024 *  8  * 16;		// Legacy PSX card default size
 
 static const int MC2_MBSIZE	= 1024 * 528 * 2;		// Size of a single megabyte of card data
 static const int MC2_SIZE	= MC2_MBSIZE * 8;		// PS2 card default size (8MB)
 
+static const uint MCD_BLOCKSIZE	= 528 * 16;			// One erase block; the unit of buffered write-back
+
+class FileMemoryCard;
+
+// --------------------------------------------------------------------------------------
+//  McdWriteBackThread
+// --------------------------------------------------------------------------------------
+// Writes buffered memory card changes back to disk.  Games save in bursts of many small
+// page writes, so the thread waits for the cards to go quiet (or for MaxDelay to pass)
+// before flushing, which coalesces a whole save into a single pass.
+//
+class McdWriteBackThread : public pxThread
+{
+	typedef pxThread _parent;
+
+	static const int QuietTime	= 250;		// in ms
+	static const int MaxDelay	= 2000;		// in ms
+
+protected:
+	FileMemoryCard&		m_card;
+	Semaphore			m_wake;
+	volatile u32		m_pending;		// set on the first write after a flush
+	volatile u32		m_writes;		// bumped on every write, to detect bursts
+	volatile bool		m_quit;
+
+public:
+	McdWriteBackThread( FileMemoryCard& card )
+		: pxThread( L"McdWriteBack" )
+		, m_card( card )
+	{
+		m_pending	= 0;
+		m_writes	= 0;
+		m_quit		= false;
+	}
+
+	virtual ~McdWriteBackThread() throw()
+	{
+		Stop();
+	}
+
+	void Start()
+	{
+		m_quit		= false;
+		m_pending	= 0;
+		m_wake.Reset();
+		_parent::Start();
+	}
+
+	void Stop();
+
+	// Called by the emulation thread after each buffered write.
+	void Notify()
+	{
+		AtomicIncrement( m_writes );
+		if( !AtomicExchange( m_pending, 1 ) )
+			m_wake.Post();
+	}
+
+protected:
+	void ExecuteTaskInThread();
+};
+
 // --------------------------------------------------------------------------------------
 //  FileMemoryCard
 // --------------------------------------------------------------------------------------
 // Provides thread-safe direct file IO mapping.
 //
+// With EmuConfig.McdBufferedWrites, each card image is instead read into memory when the
+// card is opened and SIO accesses are served from there.  Writes mark their erase blocks
+// dirty, and McdWriteBackThread writes runs of dirty blocks back in place, then flushes and
+// fsyncs the file, so a crash loses at most the last couple of seconds of saving.
+//
 class FileMemoryCard
 {
 protected:
@@ -52,6 +129,13 @@ protected:
 	u8				m_effeffs[528*16];
 	SafeArray<u8>	m_currentdata;
 
+	bool				m_buffered;
+	SafeArray<u8>		m_image[8];
+	std::vector<bool>	m_dirty[8];		// one flag per MCD_BLOCKSIZE block of the file
+	SafeArray<u8>		m_flushbuf;
+	Mutex				m_lock;			// guards m_image and m_dirty against the write-back thread
+	McdWriteBackThread	m_writeback;
+
 public:
 	FileMemoryCard();
 	virtual ~FileMemoryCard() throw() {}
@@ -61,6 +145,7 @@ public:
 
 	void Open();
 	void Close();
+	void Flush();
 
 	s32  IsPresent	( uint slot );
 	void GetSizeInfo( uint slot, PS2E_McdSizeInfo& outways );
@@ -74,6 +159,11 @@ protected:
 	bool Seek( wxFFile& f, u32 adr );
 	bool Create( const wxString& mcdFile, uint sizeInMB );
 
+	u32  GetLength( uint slot );
+	bool LoadImage( uint slot );
+	u8*  GetImagePtr( uint slot, u32 adr, int size );
+	void MarkDirty( uint slot, const u8* ptr, int size );
+
 	wxString GetDisabledMessage( uint slot ) const
 	{
 		return wxsFormat( pxE( L"The PS2-slot %d has been automatically disabled.  You can correct the problem\nand re-enable it at any time using Config:Memory cards from the main menu."
@@ -135,13 +225,47 @@ wxString FileMcd_GetDefaultName(uint slot)
 		return wxsFormat( L"Mcd%03u.ps2", slot+1 );
 }
 
+void McdWriteBackThread::Stop()
+{
+	if( !IsRunning() ) return;
+
+	m_quit = true;
+	m_wake.Post();
+	Block();
+}
+
+void McdWriteBackThread::ExecuteTaskInThread()
+{
+	while( true )
+	{
+		m_wake.WaitWithoutYield();
+		if( m_quit ) return;
+
+		for( int waited = 0; waited < MaxDelay && !m_quit; waited += QuietTime )
+		{
+			u32 writes = AtomicRead( m_writes );
+			Threading::Sleep( QuietTime );
+			if( AtomicRead( m_writes ) == writes ) break;
+		}
+
+		// Cleared before flushing, so that any write landing during the flush wakes us
+		// up again.
+		AtomicExchange( m_pending, 0 );
+		m_card.Flush();
+	}
+}
+
 FileMemoryCard::FileMemoryCard()
+	: m_writeback( *this )
 {
 	memset8<0xff>( m_effeffs );
+	m_buffered = false;
 }
 
 void FileMemoryCard::Open()
 {
+	m_buffered = EmuConfig.McdBufferedWrites;
+
 	for( int slot=0; slot<8; ++slot )
 	{
 		if( FileMcd_IsMultitapSlot(slot) )
@@ -201,20 +325,110 @@ void FileMemoryCard::Open()
 				GetDisabledMessage( slot )
 			);
 		}
+		else if( m_buffered && !LoadImage( slot ) )
+		{
+			Msgbox::Alert(
+				wxsFormat(_( "Could not read memory card: \n\n%s\n\n" ), str.c_str()) +
+				GetDisabledMessage( slot )
+			);
+			m_file[slot].Close();
+		}
 	}
+
+	if( m_buffered )
+		m_writeback.Start();
 }
 
 void FileMemoryCard::Close()
 {
+	// Anything still dirty is written out here, on the calling thread.
+	m_writeback.Stop();
+	Flush();
+
 	for( int slot=0; slot<8; ++slot )
+	{
 		m_file[slot].Close();
+		m_image[slot].Dispose();
+		m_dirty[slot].clear();
+	}
+
+	m_flushbuf.Dispose();
 }
 
-// Returns FALSE if the seek failed (is outside the bounds of the file).
-bool FileMemoryCard::Seek( wxFFile& f, u32 adr )
+bool FileMemoryCard::LoadImage( uint slot )
 {
-	const u32 size = f.Length();
+	wxFFile& mcfp( m_file[slot] );
+	const u32 size = mcfp.Length();
+
+	m_image[slot].ExactAlloc( size );
+	if( !mcfp.Seek( 0 ) || mcfp.Read( m_image[slot].GetPtr(), size ) != size )
+	{
+		m_image[slot].Dispose();
+		return false;
+	}
+
+	m_dirty[slot].assign( (size + MCD_BLOCKSIZE - 1) / MCD_BLOCKSIZE, false );
+	return true;
+}
 
+// Writes all dirty blocks back to the card files.  Called on the write-back thread, or on
+// the emulation thread once the write-back thread has been stopped.
+void FileMemoryCard::Flush()
+{
+	std::vector< std::pair<u32, u32> > runs;
+
+	for( int slot=0; slot<8; ++slot )
+	{
+		if( m_dirty[slot].empty() ) continue;
+
+		const u32 size = m_image[slot].GetSizeInBytes();
+		const uint blocks = m_dirty[slot].size();
+		u32 staged = 0;
+
+		// Copy the dirty runs out under the lock, then do the file IO without it so that
+		// SIO is never held up by the disk.
+		ScopedLock lock( m_lock );
+		runs.clear();
+		m_flushbuf.MakeRoomFor( size );
+
+		for( uint block=0; block<blocks; )
+		{
+			if( !m_dirty[slot][block] ) { ++block; continue; }
+
+			const uint first = block;
+			while( block < blocks && m_dirty[slot][block] )
+				m_dirty[slot][block++] = false;
+
+			const u32 start	= first * MCD_BLOCKSIZE;
+			const u32 len	= std::min( block * MCD_BLOCKSIZE, size ) - start;
+			memcpy_fast( m_flushbuf.GetPtr( staged ), m_image[slot].GetPtr( start ), len );
+			runs.push_back( std::make_pair( start, len ) );
+			staged += len;
+		}
+		lock.Release();
+
+		if( runs.empty() ) continue;
+
+		wxFFile& mcfp( m_file[slot] );
+		staged = 0;
+		for( uint i=0; i<runs.size(); ++i )
+		{
+			if( !mcfp.Seek( runs[i].first ) || mcfp.Write( m_flushbuf.GetPtr( staged ), runs[i].second ) != runs[i].second )
+				Console.Error( "(FileMcd) Failed writing back memory card in slot %u.", slot );
+			staged += runs[i].second;
+		}
+
+		mcfp.Flush();
+#ifdef _WIN32
+		_commit( _fileno( mcfp.fp() ) );
+#else
+		fsync( fileno( mcfp.fp() ) );
+#endif
+	}
+}
+
+static u32 GetHeaderOffset( u32 size )
+{
 	// If anyone knows why this filesize logic is here (it appears to be related to legacy PSX
 	// cards, perhaps hacked support for some special emulator-specific memcard formats that
 	// had header info?), then please replace this comment with something useful.  Thanks!  -- air
@@ -230,7 +444,38 @@ bool FileMemoryCard::Seek( wxFFile& f, u32 adr )
 		// perform sanity checks here?
 	}
 
-	return f.Seek( adr + offset );
+	return offset;
+}
+
+// Returns FALSE if the seek failed (is outside the bounds of the file).
+bool FileMemoryCard::Seek( wxFFile& f, u32 adr )
+{
+	return f.Seek( adr + GetHeaderOffset( f.Length() ) );
+}
+
+// Returns NULL if the access falls outside the card image.
+u8* FileMemoryCard::GetImagePtr( uint slot, u32 adr, int size )
+{
+	const u32 length = m_image[slot].GetSizeInBytes();
+	const u32 pos = adr + GetHeaderOffset( length );
+
+	if( pos > length || (u32)size > length - pos ) return NULL;
+	return m_image[slot].GetPtr( pos );
+}
+
+void FileMemoryCard::MarkDirty( uint slot, const u8* ptr, int size )
+{
+	const u32 pos = ptr - m_image[slot].GetPtr();
+
+	for( u32 block = pos / MCD_BLOCKSIZE; block <= (pos + size - 1) / MCD_BLOCKSIZE; ++block )
+		m_dirty[slot][block] = true;
+}
+
+// The file length is cached by the buffered image; wxFFile::Length seeks, which would race
+// with the write-back thread.
+u32 FileMemoryCard::GetLength( uint slot )
+{
+	return m_buffered ? m_image[slot].GetSizeInBytes() : m_file[slot].Length();
 }
 
 // returns FALSE if an error occurred (either permission denied or disk full)
@@ -262,14 +507,14 @@ void FileMemoryCard::GetSizeInfo( uint slot, PS2E_McdSizeInfo& outways )
 	outways.EraseBlockSizeInSectors			= 16;
 
 	if( pxAssert( m_file[slot].IsOpened() ) )
-		outways.McdSizeInSectors	= m_file[slot].Length() / (outways.SectorSize + outways.EraseBlockSizeInSectors);
+		outways.McdSizeInSectors	= GetLength( slot ) / (outways.SectorSize + outways.EraseBlockSizeInSectors);
 	else
 		outways.McdSizeInSectors	= 0x4000;
 }
 
 bool FileMemoryCard::IsPSX( uint slot )
 {
-	return m_file[slot].Length() == 0x20000;
+	return GetLength( slot ) == 0x20000;
 }
 
 s32 FileMemoryCard::Read( uint slot, u8 *dest, u32 adr, int size )
@@ -281,6 +526,16 @@ s32 FileMemoryCard::Read( uint slot, u8 *dest, u32 adr, int size )
 		memset(dest, 0, size);
 		return 1;
 	}
+
+	if( m_buffered )
+	{
+		// The write-back thread only ever reads the image, so no lock is needed here.
+		const u8* src = GetImagePtr( slot, adr, size );
+		if( !src ) return 0;
+		memcpy_fast( dest, src, size );
+		return 1;
+	}
+
 	if( !Seek(mcfp, adr) ) return 0;
 	return mcfp.Read( dest, size ) != 0;
 }
@@ -295,6 +550,26 @@ s32 FileMemoryCard::Save( uint slot, const u8 *src, u32 adr, int size )
 		return 1;
 	}
 
+	if( m_buffered )
+	{
+		ScopedLock lock( m_lock );
+		u8* dest = GetImagePtr( slot, adr, size );
+		if( !dest ) return 0;
+
+		for (int i=0; i<size; i++)
+		{
+			if ((dest[i] & src[i]) != src[i])
+				Console.Warning("(FileMcd) Warning: writing to uncleared data.");
+			dest[i] &= src[i];
+		}
+
+		MarkDirty( slot, dest, size );
+		lock.Release();
+
+		m_writeback.Notify();
+		return 1;
+	}
+
 	if( !Seek(mcfp, adr) ) return 0;
 	m_currentdata.MakeRoomFor( size );
 	mcfp.Read( m_currentdata.GetPtr(), size);
@@ -320,6 +595,20 @@ s32 FileMemoryCard::EraseBlock( uint slot, u32 adr )
 		return 1;
 	}
 
+	if( m_buffered )
+	{
+		ScopedLock lock( m_lock );
+		u8* dest = GetImagePtr( slot, adr, sizeof(m_effeffs) );
+		if( !dest ) return 0;
+
+		memcpy_fast( dest, m_effeffs, sizeof(m_effeffs) );
+		MarkDirty( slot, dest, sizeof(m_effeffs) );
+		lock.Release();
+
+		m_writeback.Notify();
+		return 1;
+	}
+
 	if( !Seek(mcfp, adr) ) return 0;
 	return mcfp.Write( m_effeffs, sizeof(m_effeffs) ) != 0;
 }
@@ -329,11 +618,25 @@ u64 FileMemoryCard::GetCRC( uint slot )
 	wxFFile& mcfp( m_file[slot] );
 	if( !mcfp.IsOpened() ) return 0;
 
+	u64 retval = 0;
+	u64 buffer[528*8];		// use 528 (sector size), ensures even divisibility
+
+	if( m_buffered )
+	{
+		const u32 length = GetLength( slot );
+		const u32 offset = GetHeaderOffset( length );
+		const u32 bytes = std::min<u32>( (length / sizeof(buffer)) * sizeof(buffer), length - offset );
+
+		const u64* data = (const u64*)m_image[slot].GetPtr( offset );
+		for( uint t=0; t<bytes / sizeof(u64); ++t )
+			retval ^= data[t];
+
+		return retval;
+	}
+
 	if( !Seek( mcfp, 0 ) ) return 0;
 
 	// Process the file in 4k chunks.  Speeds things up significantly.
-	u64 retval = 0;
-	u64 buffer[528*8];		// use 528 (sector size), ensures even divisibility
 	
 	const uint filesize = mcfp.Length() / sizeof(buffer);
 	for( uint i=filesize; i; --i )
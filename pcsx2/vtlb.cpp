@@ -58,35 +58,59 @@ static vtlbHandler UnmappedPhyHandler1;
 
 __inline int CheckCache(u32 addr)
 {
-	u32 mask;
-
 	if(((cpuRegs.CP0.n.Config >> 16) & 0x1) == 0) 
 	{
 		//DevCon.Warning("Data Cache Disabled! %x", cpuRegs.CP0.n.Config);
 		return false;//
 	}
 
+	u32 page = addr >> VTLB_PAGE_BITS;
+	return (vtlbdata.cachemap[page >> 5] >> (page & 31)) & 1;
+}
+
+static void vtlb_MarkCached(u32 addr, u32 pages)
+{
+	u32 page = addr >> VTLB_PAGE_BITS;
+
+	while (pages--)
+	{
+		vtlbdata.cachemap[page >> 5] |= 1 << (page & 31);
+		page = (page + 1) & (VTLB_VMAP_ITEMS - 1);
+	}
+}
+
+// Rebuilds the cached page bitmap from the TLB.  Called whenever a TLB entry is (re)mapped.
+// Matches pages against each entry's PFN ranges the same way the old per-access TLB scan
+// did, but at page granularity.
+void vtlb_UpdateCacheMap()
+{
+	bool used = false;
+
 	for(int i = 1; i < 48; i++)
 	{
-		if (((tlb[i].EntryLo1 & 0x38) >> 3) == 0x3) {
-			mask  = tlb[i].PageMask;
-			
-			if ((addr >= tlb[i].PFN1) && (addr <= tlb[i].PFN1 + mask)) {
-				//DevCon.Warning("Yay! Cache check cache addr=%x, mask=%x, addr+mask=%x, VPN2=%x PFN0=%x", addr, mask, (addr & mask), tlb[i].VPN2, tlb[i].PFN0); 
-				return true;
-			}
-		}
-		if (((tlb[i].EntryLo0 & 0x38) >> 3) == 0x3) {
-			mask  = tlb[i].PageMask;
-			
-			if ((addr >= tlb[i].PFN0) && (addr <= tlb[i].PFN0 + mask)) {
-				//DevCon.Warning("Yay! Cache check cache addr=%x, mask=%x, addr+mask=%x, VPN2=%x PFN0=%x", addr, mask, (addr & mask), tlb[i].VPN2, tlb[i].PFN0); 
-				return true;
-			}
+		if ((((tlb[i].EntryLo0 & 0x38) >> 3) == 0x3) || (((tlb[i].EntryLo1 & 0x38) >> 3) == 0x3))
+		{
+			used = true;
+			break;
 		}
 	}
-	return false;
+
+	// Nothing cached before or after: skip the clear (the common case).
+	if (!used && !vtlbdata.cachemap_used) return;
+
+	memzero(vtlbdata.cachemap);
+	vtlbdata.cachemap_used = used;
+
+	for(int i = 1; i < 48; i++)
+	{
+		if (((tlb[i].EntryLo1 & 0x38) >> 3) == 0x3)
+			vtlb_MarkCached(tlb[i].PFN1, tlb[i].Mask + 1);
+
+		if (((tlb[i].EntryLo0 & 0x38) >> 3) == 0x3)
+			vtlb_MarkCached(tlb[i].PFN0, tlb[i].Mask + 1);
+	}
 }
+
 // --------------------------------------------------------------------------------------
 // Interpreter Implementations of VTLB Memory Operations.
 // --------------------------------------------------------------------------------------
@@ -101,24 +125,21 @@ DataType __fastcall vtlb_memRead(u32 addr)
 
 	if (!(ppf<0))
 	{
-		if (!CHECK_EEREC) 
+		if(CHECK_CACHE && CheckCache(addr)) 
 		{
-			if(CHECK_CACHE && CheckCache(addr)) 
+			switch( DataSize )
 			{
-				switch( DataSize )
-				{
-					case 8: 
-						return readCache8(addr);
-						break;
-					case 16: 
-						return readCache16(addr);
-						break;
-					case 32: 
-						return readCache32(addr);
-						break;
-
-					jNO_DEFAULT;
-				}
+				case 8: 
+					return readCache8(addr);
+					break;
+				case 16: 
+					return readCache16(addr);
+					break;
+				case 32: 
+					return readCache32(addr);
+					break;
+
+				jNO_DEFAULT;
 			}
 		}
 
@@ -156,12 +177,10 @@ void __fastcall vtlb_memRead64(u32 mem, mem64_t *out)
 
 	if (!(ppf<0))
 	{
-		if (!CHECK_EEREC) {
-			if(CHECK_CACHE && CheckCache(mem)) 
-			{
-				*out = readCache64(mem);
-				return;
-			}
+		if(CHECK_CACHE && CheckCache(mem)) 
+		{
+			*out = readCache64(mem);
+			return;
 		}
 
 		*out = *(mem64_t*)ppf;
@@ -183,14 +202,11 @@ void __fastcall vtlb_memRead128(u32 mem, mem128_t *out)
 
 	if (!(ppf<0))
 	{
-		if (!CHECK_EEREC) 
+		if(CHECK_CACHE && CheckCache(mem)) 
 		{
-			if(CHECK_CACHE && CheckCache(mem)) 
-			{
-				out->lo = readCache64(mem);
-				out->hi = readCache64(mem+8);
-				return;
-			}
+			out->lo = readCache64(mem);
+			out->hi = readCache64(mem+8);
+			return;
 		}
 
 		CopyQWC(out,(void*)ppf);
@@ -215,22 +231,19 @@ void __fastcall vtlb_memWrite(u32 addr, DataType data)
 	s32 ppf=addr+vmv;
 	if (!(ppf<0))
 	{		
-		if (!CHECK_EEREC) 
+		if(CHECK_CACHE && CheckCache(addr)) 
 		{
-			if(CHECK_CACHE && CheckCache(addr)) 
+			switch( DataSize )
 			{
-				switch( DataSize )
-				{
-				case 8: 
-					writeCache8(addr, data);
-					return;
-				case 16:
-					writeCache16(addr, data);
-					return;
-				case 32:
-					writeCache32(addr, data);
-					return;
-				}
+			case 8: 
+				writeCache8(addr, data);
+				return;
+			case 16:
+				writeCache16(addr, data);
+				return;
+			case 32:
+				writeCache32(addr, data);
+				return;
 			}
 		}
 
@@ -263,13 +276,10 @@ void __fastcall vtlb_memWrite64(u32 mem, const mem64_t* value)
 	s32 ppf=mem+vmv;
 	if (!(ppf<0))
 	{		
-		if (!CHECK_EEREC) 
+		if(CHECK_CACHE && CheckCache(mem)) 
 		{
-			if(CHECK_CACHE && CheckCache(mem)) 
-			{
-				writeCache64(mem, *value);
-				return;
-			}
+			writeCache64(mem, *value);
+			return;
 		}
 
 		*(mem64_t*)ppf = *value;
@@ -291,13 +301,10 @@ void __fastcall vtlb_memWrite128(u32 mem, const mem128_t *value)
 	s32 ppf=mem+vmv;
 	if (!(ppf<0))
 	{
-		if (!CHECK_EEREC) 
+		if(CHECK_CACHE && CheckCache(mem)) 
 		{
-			if(CHECK_CACHE && CheckCache(mem)) 
-			{
-				writeCache128(mem, value);
-				return;
-			}
+			writeCache128(mem, value);
+			return;
 		}
 
 		CopyQWC((void*)ppf, value);
@@ -563,6 +570,24 @@ __fi void* vtlb_GetPhyPtr(u32 paddr)
 		return reinterpret_cast<void*>(vtlbdata.pmap[paddr>>VTLB_PAGE_BITS]+(paddr&VTLB_PAGE_MASK));
 }
 
+// All vmap updates go through here, so that the fastmem bookkeeping stays in sync with
+// the actual mappings.
+static __fi void vtlb_SetVirtPage(u32 vaddr, s32 vmv)
+{
+	s32& entry = vtlbdata.vmap[vaddr>>VTLB_PAGE_BITS];
+
+	if ((vaddr & VTLB_FASTMEM_MASK) < Ps2MemSize::MainRam)
+	{
+		u32 ram = (uptr)eeMem->Main + (vaddr & VTLB_FASTMEM_MASK);
+
+		vtlbdata.fastmem_misses += (vaddr + entry) == ram;
+		vtlbdata.fastmem_misses -= (vaddr + vmv) == ram;
+		vtlbdata.fastmem_limit = vtlbdata.fastmem_misses ? 0 : Ps2MemSize::MainRam;
+	}
+
+	entry = vmv;
+}
+
 //virtual mappings
 //TODO: Add invalid paddr checks
 void vtlb_VMap(u32 vaddr,u32 paddr,u32 size)
@@ -589,7 +614,7 @@ void vtlb_VMap(u32 vaddr,u32 paddr,u32 size)
 				pme |= paddr;// top bit is set anyway ...
 		}
 
-		vtlbdata.vmap[vaddr>>VTLB_PAGE_BITS] = pme-vaddr;
+		vtlb_SetVirtPage(vaddr, pme-vaddr);
 		vaddr += VTLB_PAGE_SIZE;
 		paddr += VTLB_PAGE_SIZE;
 		size -= VTLB_PAGE_SIZE;
@@ -604,7 +629,7 @@ void vtlb_VMapBuffer(u32 vaddr,void* buffer,u32 size)
 	u32 bu8 = (u32)buffer;
 	while (size > 0)
 	{
-		vtlbdata.vmap[vaddr>>VTLB_PAGE_BITS] = bu8-vaddr;
+		vtlb_SetVirtPage(vaddr, bu8-vaddr);
 		vaddr += VTLB_PAGE_SIZE;
 		bu8 += VTLB_PAGE_SIZE;
 		size -= VTLB_PAGE_SIZE;
@@ -626,7 +651,7 @@ void vtlb_VMapUnmap(u32 vaddr,u32 size)
 		handl |= vaddr; // top bit is set anyway ...
 		handl |= 0x80000000;
 
-		vtlbdata.vmap[vaddr>>VTLB_PAGE_BITS] = handl-vaddr;
+		vtlb_SetVirtPage(vaddr, handl-vaddr);
 		vaddr += VTLB_PAGE_SIZE;
 		size -= VTLB_PAGE_SIZE;
 	}
@@ -668,6 +693,13 @@ void vtlb_Init()
 	//yeah i know, its stupid .. but this code has to be here for now ;p
 	vtlb_VMapUnmap((VTLB_VMAP_ITEMS-1)*VTLB_PAGE_SIZE,VTLB_PAGE_SIZE);
 
+	// The vmap held garbage before the unmap above, so restart the fastmem count from scratch.
+	vtlbdata.fastmem_misses = VTLB_FASTMEM_ITEMS;
+	vtlbdata.fastmem_limit = 0;
+
+	memzero(vtlbdata.cachemap);
+	vtlbdata.cachemap_used = false;
+
 	extern void vtlb_dynarec_init();
 	vtlb_dynarec_init();
 }
@@ -66,6 +66,7 @@ extern void* vtlb_GetPhyPtr(u32 paddr);
 extern void vtlb_VMap(u32 vaddr,u32 paddr,u32 sz);
 extern void vtlb_VMapBuffer(u32 vaddr,void* buffer,u32 sz);
 extern void vtlb_VMapUnmap(u32 vaddr,u32 sz);
+extern void vtlb_UpdateCacheMap();
 
 //Memory functions
 
@@ -87,6 +88,8 @@ extern void vtlb_DynGenWrite_Const( u32 bits, u32 addr_const );
 extern void vtlb_DynGenRead64_Const( u32 bits, u32 addr_const );
 extern void vtlb_DynGenRead32_Const( u32 bits, bool sign, u32 addr_const );
 
+extern void vtlb_dynarec_init();
+
 // --------------------------------------------------------------------------------------
 //  VtlbMemoryReserve
 // --------------------------------------------------------------------------------------
@@ -187,6 +190,12 @@ namespace vtlb_private
 
 	static const uint VTLB_HANDLER_ITEMS = 128;
 
+	// Fastmem -- recompiled code may access kuseg/kseg0 main RAM directly as
+	// eeMem->Main + (vaddr & VTLB_FASTMEM_MASK), as long as all of those pages are
+	// mapped 1:1 onto main RAM (see MapData::fastmem_limit).
+	static const u32 VTLB_FASTMEM_MASK	= 0x7fffffff;
+	static const uint VTLB_FASTMEM_ITEMS = (Ps2MemSize::MainRam / VTLB_PAGE_SIZE) * 2;
+
 	struct MapData
 	{
 		// first indexer -- 8/16/32/64/128 bit tables [values 0-4]
@@ -198,9 +207,23 @@ namespace vtlb_private
 
 		s32* vmap;				//4MB (allocated by vtlb_init)
 
+		// Number of fastmem pages not mapped 1:1 onto main RAM, and the bound recompiled
+		// code checks masked addresses against.  The bound drops to 0 (everything takes the
+		// vmap path) whenever the TLB breaks the 1:1 view.
+		u32 fastmem_misses;
+		u32 fastmem_limit;
+
+		// One bit per virtual page, set for pages covered by a TLB entry in cached mode
+		// (C=3).  Used by EE data cache emulation (see vtlb_UpdateCacheMap).
+		u32 cachemap[VTLB_VMAP_ITEMS / 32];	//128KB
+		bool cachemap_used;
+
 		MapData()
 		{
 			vmap = NULL;
+			fastmem_misses = VTLB_FASTMEM_ITEMS;
+			fastmem_limit = 0;
+			cachemap_used = false;
 		}
 	};
 
@@ -17,55 +17,62 @@
 #include "PrecompiledHeader.h"
 #include "BaseblockEx.h"
 
-BASEBLOCKEX* BaseBlocks::New(u32 startpc, uptr fnptr)
+void BaseBlocks::PatchLinks(u32 pc, uptr target)
 {
-	std::pair<linkiter_t, linkiter_t> range = links.equal_range(startpc);
-	for (linkiter_t i = range.first; i != range.second; ++i)
-		*(u32*)i->second = fnptr - (i->second + 4);
-	
-	return blocks.insert(startpc, fnptr);;
+	linkheads_t::const_iterator head = links.find(pc);
+	if (head == links.end())
+		return;
+
+	for (u32 i = head->second; i != BASEBLOCKLINK_NONE; i = linkpool[i].next)
+	{
+		uptr site = linkpool[i].site;
+		*(u32*)site = target - (site + 4);
+	}
 }
 
-int BaseBlocks::LastIndex(u32 startpc) const
+BASEBLOCKEX* BaseBlocks::New(u32 startpc, uptr fnptr)
 {
-	if (0 == blocks.size())
-		return -1;
-
-	int imin = 0, imax = blocks.size() - 1, imid;
-
-	while(imin != imax) {
-		imid = (imin+imax+1)>>1;
-
-		if (blocks[imid].startpc > startpc)
-			imax = imid - 1;
-		else
-			imin = imid;
-	}
+	PatchLinks(startpc, fnptr);
 
-	return imin;
+	BASEBLOCKEX& block = blocks[startpc];
+	memzero(block);
+	block.startpc = startpc;
+	block.fnptr = fnptr;
+	return &block;
 }
 
 BASEBLOCKEX* BaseBlocks::GetByX86(uptr ip)
 {
-	if (0 == blocks.size())
-		return 0;
-
-	int imin = 0, imax = blocks.size() - 1, imid;
+	// Only used for debugging, so a linear walk is fine (blocks aren't ordered by fnptr).
+	for (iterator iter = blocks.begin(); iter != blocks.end(); ++iter)
+	{
+		BASEBLOCKEX& block = iter->second;
+		if (ip >= block.fnptr && ip < block.fnptr + block.x86size)
+			return &block;
+	}
 
-	while(imin != imax) {
-		imid = (imin+imax+1)>>1;
+	return 0;
+}
 
-		if (blocks[imid].fnptr > ip)
-			imax = imid - 1;
-		else
-			imin = imid;
+void BaseBlocks::Remove(iterator first, iterator last)
+{
+	for (iterator iter = first; iter != last; ++iter)
+	{
+		PatchLinks(iter->first, recompiler);
+
+		if( IsDevBuild )
+		{
+			// Clear the first instruction to 0xcc (breakpoint), as a way to assert if some
+			// static jumps get left behind to this block.  Note: Do not clear more than the
+			// first byte, since this code is called during exception handlers and event handlers
+			// both of which expect to be able to return to the recompiled code.
+
+			memset( (void*)iter->second.fnptr, 0xcc, 1 );
+		}
 	}
 
-	if (ip < blocks[imin].fnptr ||
-		ip >= blocks[imin].fnptr + blocks[imin].x86size)
-		return 0;
-
-	return &blocks[imin];
+	// TODO: remove links from this block?
+	blocks.erase(first, last);
 }
 
 void BaseBlocks::Link(u32 pc, s32* jumpptr)
@@ -75,6 +82,64 @@ void BaseBlocks::Link(u32 pc, s32* jumpptr)
 		*jumpptr = (s32)(targetblock->fnptr - (sptr)(jumpptr + 1));
 	else
 		*jumpptr = (s32)(recompiler - (sptr)(jumpptr + 1));
-	links.insert(std::pair<u32, uptr>(pc, (uptr)jumpptr));
+
+	u32 node;
+	if (linkfree != BASEBLOCKLINK_NONE)
+	{
+		node = linkfree;
+		linkfree = linkpool[node].next;
+	}
+	else
+	{
+		node = linkpool.size();
+		linkpool.push_back(BASEBLOCKLINK());
+	}
+
+	linkheads_t::iterator head = links.find(pc);
+	linkpool[node].site = (uptr)jumpptr;
+	linkpool[node].next = (head != links.end()) ? head->second : BASEBLOCKLINK_NONE;
+
+	if (head != links.end())
+		head->second = node;
+	else
+		links[pc] = node;
 }
 
+
+// Removes every block whose code starts within [lo, hi), so the code memory can be reused.
+// Links into the removed blocks are pointed back at the recompiler, and links emitted by
+// the removed code are forgotten (they're about to be overwritten).
+void BaseBlocks::RemoveX86Range(uptr lo, uptr hi)
+{
+	for (iterator iter = blocks.begin(); iter != blocks.end(); )
+	{
+		if (iter->second.fnptr >= lo && iter->second.fnptr < hi)
+		{
+			PatchLinks(iter->first, recompiler);
+			blocks.erase(iter++);
+		}
+		else
+			++iter;
+	}
+
+	for (linkheads_t::iterator head = links.begin(); head != links.end(); ++head)
+	{
+		u32* prev = &head->second;
+
+		while (*prev != BASEBLOCKLINK_NONE)
+		{
+			BASEBLOCKLINK& link = linkpool[*prev];
+			if (link.site >= lo && link.site < hi)
+			{
+				u32 node = *prev;
+				*prev = link.next;
+				link.next = linkfree;
+				linkfree = node;
+			}
+			else
+				prev = &link.next;
+		}
+
+		// Empty chains are left in place; the pc is likely to be linked to again.
+	}
+}
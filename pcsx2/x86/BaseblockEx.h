@@ -16,6 +16,7 @@
 #pragma once
 
 #include <map>			// used by BaseBlockEx
+#include "Utilities/HashMap.h"
 
 // Every potential jump point in the PS2's addressable memory has a BASEBLOCK
 // associated with it. So that means a BASEBLOCK for every 4 bytes of PS2
@@ -43,138 +44,51 @@ struct BASEBLOCKEX
 
 };
 
-class BaseBlockArray {
-	s32 _Reserved;
-	s32 _Size;
-	BASEBLOCKEX *blocks;
-
-	__fi void resize(s32 size)
-	{
-		pxAssert(size > 0);
-		BASEBLOCKEX *newMem = new BASEBLOCKEX[size];
-		if(blocks) {
-			memmove(newMem, blocks, _Reserved * sizeof(BASEBLOCKEX));
-			delete[] blocks;
-		}
-		blocks = newMem;
-		pxAssert(blocks != NULL);
-	}
-public:
-	BaseBlockArray() : _Size(0),
-		_Reserved(0)
-	{
-	}
-
-	~BaseBlockArray()
-	{
-		if(blocks) {
-			delete[] blocks;
-		}
-	}
-
-	BaseBlockArray (s32 size) : _Size(0),
-		_Reserved(0)
-	{
-		if(size > 0) {
-			resize(size);
-		}
-		_Reserved = size;
-	}
-
-	BASEBLOCKEX *insert(u32 startpc, uptr fnptr)
-	{
-		if(_Size + 1 >= _Reserved) {
-			resize(_Reserved + 0x2000);
-			_Reserved += 0x2000;		// some games requires even more!
-		}
-
-		int imin = 0, imax = _Size, imid;
-
-		while (imin < imax) {
-			imid = (imin+imax)>>1;
-
-			if (blocks[imid].startpc > startpc)
-				imax = imid;
-			else
-				imin = imid + 1;
-		}
-	
-		pxAssert(imin == _Size || blocks[imin].startpc > startpc);
-
-		if(imin < _Size) {
-			// make a hole for a new block.
-			memmove(blocks + imin + 1, blocks + imin, (_Size - imin) * sizeof(BASEBLOCKEX));
-		}
-
-		memset((blocks + imin), 0, sizeof(BASEBLOCKEX));
-		blocks[imin].startpc = startpc;
-		blocks[imin].fnptr = fnptr;
-
-		_Size++;
-		return &blocks[imin];
-	}
-
-	void reserve(u32 size)
-	{
-		resize(size);
-		_Reserved = size;
-	}
-
-	__fi BASEBLOCKEX &operator[](int idx) const
-	{
-		return *(blocks + idx);
-	}
-
-	void clear()
-	{
-		_Size = 0;
-	}
-
-	__fi u32 size() const
-	{
-		return _Size;
-	}
-
-	__fi void erase(s32 first)
-	{
-		return erase(first, first + 1);
-	}
-
-	__fi void erase(s32 first, s32 last)
-	{
-		int range = last - first;
-
-		if(last < _Size) {
-			memmove(blocks + first, blocks + last, (_Size - last) * sizeof(BASEBLOCKEX));
-		}
-
-		_Size -= range;
-	}
+// Link sites are kept in a pool of singly-linked nodes, chained per target pc through a hash
+// of chain heads.  Nodes are recycled through a free list, so a long session doesn't keep
+// growing the pool, and walking a target's links touches one small contiguous array.
+struct BASEBLOCKLINK
+{
+	uptr site;		// address of the rel32 displacement to patch
+	u32 next;		// index of the next link to the same pc, or BASEBLOCKLINK_NONE
 };
 
+static const u32 BASEBLOCKLINK_NONE = (u32)-1;
+
 class BaseBlocks
 {
+public:
+	typedef std::map<u32, BASEBLOCKEX> blockmap_t;
+	typedef blockmap_t::iterator iterator;
+
 protected:
-	typedef std::multimap<u32, uptr>::iterator linkiter_t;
+	typedef HashTools::HashMap<u32, u32> linkheads_t;
+
+	// Blocks are ordered by startpc, so lookups, inserts, erases and range walks (recClear)
+	// are all O(log n), and BASEBLOCKEX pointers stay valid until the block is removed.
+	blockmap_t blocks;
+
+	linkheads_t links;
+	std::vector<BASEBLOCKLINK> linkpool;
+	u32 linkfree;
 
-	// switch to a hash map later?
-	std::multimap<u32, uptr> links;
 	uptr recompiler;
-	BaseBlockArray blocks;
+
+	void PatchLinks(u32 pc, uptr target);
 
 public:
 	BaseBlocks() :
-		recompiler( NULL )
-	,	blocks(0)
+		links( (u32)-1, (u32)-2, 0x4000 )
+	,	linkfree( BASEBLOCKLINK_NONE )
+	,	recompiler( NULL )
 	{
-		blocks.reserve(0x4000);
 	}
 
 	BaseBlocks(uptr recompiler_) :
-		recompiler(recompiler_),
-		blocks(0)
+		links( (u32)-1, (u32)-2, 0x4000 )
+	,	linkfree( BASEBLOCKLINK_NONE )
+	,	recompiler( recompiler_ )
 	{
-		blocks.reserve(0x4000);
 	}
 
 	void SetJITCompile( void (*recompiler_)() )
@@ -183,68 +97,45 @@ public:
 	}
 
 	BASEBLOCKEX* New(u32 startpc, uptr fnptr);
-	int LastIndex (u32 startpc) const;
 	BASEBLOCKEX* GetByX86(uptr ip);
 
-	__fi int Index (u32 startpc) const
-	{
-		int idx = LastIndex(startpc);
-
-		if ((idx == -1) || (startpc < blocks[idx].startpc) ||
-			((blocks[idx].size) && (startpc >= blocks[idx].startpc + blocks[idx].size * 4)))
-			return -1;
-		else
-			return idx;
-	}
-
-	__fi BASEBLOCKEX* operator[](int idx)
-	{
-		if (idx < 0 || idx >= (int)blocks.size())
-			return 0;
-
-		return &blocks[idx];
-	}
+	__fi iterator Begin()	{ return blocks.begin(); }
+	__fi iterator End()		{ return blocks.end(); }
 
-	__fi BASEBLOCKEX* Get(u32 startpc)
+	// Returns the first block starting after pc (End() if there is none).  The block before
+	// it, if any, is the last one starting at or before pc.
+	__fi iterator UpperBound(u32 pc)
 	{
-		return (*this)[Index(startpc)];
+		return blocks.upper_bound(pc);
 	}
 
-	__fi void Remove(int first, int last)
+	// Returns the block containing pc, or NULL.  A block with no size yet (still being
+	// compiled) is treated as containing everything from its start address on.
+	__fi BASEBLOCKEX* Get(u32 pc)
 	{
-		pxAssert(first <= last);
-		int idx = first;
-		do{
-			pxAssert(idx <= last);
+		iterator iter = blocks.upper_bound(pc);
+		if (iter == blocks.begin())
+			return NULL;
 
-			//u32 startpc = blocks[idx].startpc;
-			std::pair<linkiter_t, linkiter_t> range = links.equal_range(blocks[idx].startpc);
-			for (linkiter_t i = range.first; i != range.second; ++i)
-				*(u32*)i->second = recompiler - (i->second + 4);
+		BASEBLOCKEX& block = (--iter)->second;
+		if (block.size && pc >= block.startpc + block.size * 4)
+			return NULL;
 
-			if( IsDevBuild )
-			{
-				// Clear the first instruction to 0xcc (breakpoint), as a way to assert if some
-				// static jumps get left behind to this block.  Note: Do not clear more than the
-				// first byte, since this code is called during exception handlers and event handlers
-				// both of which expect to be able to return to the recompiled code.
-
-				BASEBLOCKEX effu( blocks[idx] );
-				memset( (void*)effu.fnptr, 0xcc, 1 );
-			}
-		}
-		while(idx++ < last);
-
-		// TODO: remove links from this block?
-		blocks.erase(first, last + 1);
+		return &block;
 	}
 
+	// Removes the blocks in [first, last), pointing any links into them back at the recompiler.
+	void Remove(iterator first, iterator last);
+
 	void Link(u32 pc, s32* jumpptr);
+	void RemoveX86Range(uptr lo, uptr hi);
 
 	__fi void Reset()
 	{
 		blocks.clear();
 		links.clear();
+		linkpool.clear();
+		linkfree = BASEBLOCKLINK_NONE;
 	}
 };
 
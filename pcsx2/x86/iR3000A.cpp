@@ -23,6 +23,7 @@
 #include "iR3000A.h"
 #include "BaseblockEx.h"
 #include "System/RecTypes.h"
+#include "SamplProf.h"
 
 #include <time.h>
 
@@ -35,6 +36,7 @@
 
 #include "NakedAsm.h"
 #include "AppConfig.h"
+#include "MTIOP.h"
 
 
 using namespace x86Emitter;
@@ -812,6 +814,8 @@ void recResetIOP()
 {
 	DevCon.WriteLn( "iR3000A Recompiler reset." );
 
+	ScopedLock lock( THREAD_IOP ? &iopThread.mtxRecompile : NULL );
+
 	recAlloc();
 	recMem->Reset();
 
@@ -926,39 +930,42 @@ static __fi u32 psxRecClearMem(u32 pc)
 	pc = HWADDR(pc);
 
 	u32 lowerextent = pc, upperextent = pc + 4;
-	int blockidx = recBlocks.Index(pc);
-	pxAssert(blockidx != -1);
+	pxAssert(recBlocks.Get(pc));
+
+	BaseBlocks::iterator iter = recBlocks.UpperBound(pc);
+	if (iter != recBlocks.Begin())
+		--iter;
 
-	while (BASEBLOCKEX* pexblock = recBlocks[blockidx - 1]) {
+	while (iter != recBlocks.Begin()) {
+		BaseBlocks::iterator prev = iter;
+		BASEBLOCKEX* pexblock = &(--prev)->second;
 		if (pexblock->startpc + pexblock->size * 4 <= lowerextent)
 			break;
 
 		lowerextent = min(lowerextent, pexblock->startpc);
-		blockidx--;
+		iter = prev;
 	}
 
-	int toRemoveFirst = blockidx;
+	BaseBlocks::iterator toRemoveFirst = iter;
 
-	while (BASEBLOCKEX* pexblock = recBlocks[blockidx]) {
+	for (; iter != recBlocks.End(); ++iter) {
+		BASEBLOCKEX* pexblock = &iter->second;
 		if (pexblock->startpc >= upperextent)
 			break;
 
 		lowerextent = min(lowerextent, pexblock->startpc);
 		upperextent = max(upperextent, pexblock->startpc + pexblock->size * 4);
-
-		blockidx++;
 	}
 
-	if(toRemoveFirst != blockidx) {
-		recBlocks.Remove(toRemoveFirst, (blockidx - 1));
-	}
+	recBlocks.Remove(toRemoveFirst, iter);
 
-	blockidx=0;
-	while(BASEBLOCKEX* pexblock = recBlocks[blockidx++])
-	{
-		if (pc >= pexblock->startpc && pc < pexblock->startpc + pexblock->size * 4) {
-			DevCon.Error("Impossible block clearing failure");
-			pxFailDev( "Impossible block clearing failure" );
+	if (IsDevBuild) {
+		for (iter = recBlocks.Begin(); iter != recBlocks.End(); ++iter) {
+			BASEBLOCKEX* pexblock = &iter->second;
+			if (pc >= pexblock->startpc && pc < pexblock->startpc + pexblock->size * 4) {
+				DevCon.Error("Impossible block clearing failure");
+				pxFailDev( "Impossible block clearing failure" );
+			}
 		}
 	}
 
@@ -1215,6 +1222,9 @@ static void __fastcall iopRecRecompile( const u32 startpc )
 
 	pxAssert( startpc );
 
+	// See recRecompile in iR5900-32.cpp
+	ScopedLock lock( THREAD_IOP ? &iopThread.mtxRecompile : NULL );
+
 	// if recPtr reached the mem limit reset whole mem
 	if (recPtr >= (recMem->GetPtrEnd() - _64kb)) {
 		recResetIOP();
@@ -1411,6 +1421,9 @@ StartRecomp:
 	pxAssert(xGetPtr() - recPtr < _64kb);
 	s_pCurBlockEx->x86size = xGetPtr() - recPtr;
 
+	if (EmuConfig.Profiler.Enabled && EmuConfig.Profiler.RecBlocks_IOP)
+		ProfilerRegisterBlock(recPtr, s_pCurBlockEx->x86size, "IOP:%08x", startpc);
+
 	recPtr = xGetPtr();
 
 	pxAssert( (g_psxHasConstReg&g_psxFlushedConstReg) == g_psxHasConstReg );
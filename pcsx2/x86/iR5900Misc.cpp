@@ -199,11 +199,10 @@ void recMTSAH( void )
 	// Suikoden 3 uses it a lot
 	void recCACHE() //Interpreter only!
 	{
-	   //MOV32ItoM( (uptr)&cpuRegs.code, (u32)cpuRegs.code );
-	   //MOV32ItoM( (uptr)&cpuRegs.pc, (u32)pc );
-	   //iFlushCall(FLUSH_EVERYTHING);
-	   //CALLFunc( (uptr)R5900::Interpreter::OpcodeImpl::CACHE );
-	   //branch = 2;
+		// Only meaningful when the data cache is emulated (writebacks, invalidates);
+		// otherwise it's a no-op.
+		if( CHECK_CACHE )
+			recCall( R5900::Interpreter::OpcodeImpl::CACHE );
 	}
 
 	void recTGE( void )
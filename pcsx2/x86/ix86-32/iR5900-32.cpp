@@ -23,6 +23,7 @@
 #include "iR5900.h"
 #include "BaseblockEx.h"
 #include "System/RecTypes.h"
+#include "SamplProf.h"
 
 #include "vtlb.h"
 #include "Dump.h"
@@ -31,6 +32,7 @@
 #include "GS.h"
 #include "CDVD/CDVD.h"
 #include "Elfheader.h"
+#include "MTIOP.h"
 
 #if !PCSX2_SEH
 #	include <csetjmp>
@@ -97,6 +99,12 @@ static BASEBLOCK *recROM1 = NULL;		// also here
 
 static BaseBlocks recBlocks;
 static u8* recPtr = NULL;
+
+// The code cache is filled as a ring of regions.  When the current region runs out, the
+// next one is reclaimed (its blocks are dropped) instead of resetting the whole cache.
+static const uint RECMEM_REGIONS = 8;
+static uint recRegion = 0;
+static u8* recRegionEnd = NULL;
 static u32 *recConstBufPtr = NULL;
 EEINST* s_pInstCache = NULL;
 static u32 s_nInstCacheSize = 0;
@@ -439,6 +447,7 @@ static DynGenFunc* _DynGen_JITCompile()
 	xMOV( ebx, eax );
 	xSHR( eax, 16 );
 	xMOV( ecx, ptr[recLUT + (eax*4)] );
+	if( GuestProfiler_IsEnabled() ) xMOV( ptr8[(u8*)&g_eeProfileZone], GPZ_Code );
 	xJMP( ptr32[ecx+ebx] );
 
 	return (DynGenFunc*)retval;
@@ -457,10 +466,15 @@ static DynGenFunc* _DynGen_DispatcherReg()
 	u8* retval = xGetPtr();		// fallthrough target, can't align it!
 	_DynGen_StackFrameCheck();
 
+	// The guest profiler wants to know how much time goes into block lookups; the zone
+	// stores are only generated while it's enabled (dispatchers are rebuilt on rec reset).
+	if( GuestProfiler_IsEnabled() ) xMOV( ptr8[(u8*)&g_eeProfileZone], GPZ_Dispatcher );
+
 	xMOV( eax, ptr[&cpuRegs.pc] );
 	xMOV( ebx, eax );
 	xSHR( eax, 16 );
 	xMOV( ecx, ptr[recLUT + (eax*4)] );
+	if( GuestProfiler_IsEnabled() ) xMOV( ptr8[(u8*)&g_eeProfileZone], GPZ_Code );
 	xJMP( ptr32[ecx+ebx] );
 
 	return (DynGenFunc*)retval;
@@ -701,7 +715,10 @@ static bool eeCpuExecuting = false;
 ////////////////////////////////////////////////////
 static void recResetRaw()
 {
+	ScopedLock lock( THREAD_IOP ? &iopThread.mtxRecompile : NULL );
+
 	recAlloc();
+	vtlb_dynarec_init();	// picks up guest profiler changes
 
 	if( AtomicExchange( eeRecIsReset, true ) ) return;
 	AtomicExchange( eeRecNeedsReset, false );
@@ -725,12 +742,43 @@ static void recResetRaw()
 	x86SetPtr(*recMem);
 
 	recPtr = *recMem;
+	recRegion = 0;
+	recRegionEnd = recPtr + (recMem->GetPtrEnd() - recPtr) / RECMEM_REGIONS;
 	recConstBufPtr = recConstBuf;
 	x86FpuState = FPU_STATE;
 
 	branch = 0;
 }
 
+// Moves code emission on to the next region of the code cache, discarding the blocks
+// compiled there.  Their recLUT entries go back to JITCompile, and links into them are
+// pointed back at the recompiler, so they'll simply be recompiled if needed again.
+static void recReclaimRegion()
+{
+	u8* base = *recMem;
+	uptr regionSize = (recMem->GetPtrEnd() - base) / RECMEM_REGIONS;
+
+	recRegion = (recRegion + 1) % RECMEM_REGIONS;
+	u8* start = base + recRegion * regionSize;
+	recRegionEnd = start + regionSize;
+
+	DevCon.WriteLn( "EE/iR5900-32 Recompiler: reclaiming code region %u", recRegion );
+
+	for (BaseBlocks::iterator iter = recBlocks.Begin(); iter != recBlocks.End(); ++iter)
+	{
+		BASEBLOCKEX* pexblock = &iter->second;
+		if (pexblock->fnptr < (uptr)start || pexblock->fnptr >= (uptr)recRegionEnd)
+			continue;
+
+		BASEBLOCK* pblock = PC_GETBLOCK(pexblock->startpc);
+		if (pblock->GetFnptr() == pexblock->fnptr)
+			pblock->SetFnptr((uptr)JITCompile);
+	}
+
+	recBlocks.RemoveX86Range((uptr)start, (uptr)recRegionEnd);
+	recPtr = start;
+}
+
 static void recShutdown()
 {
 	safe_delete( recMem );
@@ -878,34 +926,34 @@ void recClear(u32 addr, u32 size)
 		return;
 	addr = HWADDR(addr);
 
-	int blockidx = recBlocks.LastIndex(addr + size * 4 - 4);
+	BaseBlocks::iterator iter = recBlocks.UpperBound(addr + size * 4 - 4);
 
-	if (blockidx == -1)
+	if (iter == recBlocks.Begin())
 		return;
 
 	u32 lowerextent = (u32)-1, upperextent = 0, ceiling = (u32)-1;
 
-	BASEBLOCKEX* pexblock = recBlocks[blockidx + 1];
-	if (pexblock)
-		ceiling = pexblock->startpc;
+	if (iter != recBlocks.End())
+		ceiling = iter->second.startpc;
 
-	int toRemoveLast = blockidx;
+	BaseBlocks::iterator toRemoveEnd = iter;
 
-	while (pexblock = recBlocks[blockidx]) {
+	while (iter != recBlocks.Begin()) {
+		BASEBLOCKEX* pexblock = &(--iter)->second;
 		u32 blockstart = pexblock->startpc;
 		u32 blockend = pexblock->startpc + pexblock->size * 4;
 		BASEBLOCK* pblock = PC_GETBLOCK(blockstart);
 
 		if (pblock == s_pCurBlock) {
-			if(toRemoveLast != blockidx) {
-				recBlocks.Remove((blockidx + 1), toRemoveLast);
-			}
-			toRemoveLast = --blockidx;
+			BaseBlocks::iterator next = iter;
+			recBlocks.Remove(++next, toRemoveEnd);
+			toRemoveEnd = iter;
 			continue;
 		}
 
 		if (blockend <= addr) {
 			lowerextent = max(lowerextent, blockend);
+			++iter;
 			break;
 		}
 
@@ -914,25 +962,21 @@ void recClear(u32 addr, u32 size)
 		// This might end up inside a block that doesn't contain the clearing range,
 		// so set it to recompile now.  This will become JITCompile if we clear it.
 		pblock->SetFnptr((uptr)JITCompileInBlock);
-
-		blockidx--;
 	}
 
-	if(toRemoveLast != blockidx) {
-		recBlocks.Remove((blockidx + 1), toRemoveLast);
-	}
+	recBlocks.Remove(iter, toRemoveEnd);
 
 	upperextent = min(upperextent, ceiling);
 
-	for (int i = 0; pexblock = recBlocks[i]; i++) {
-		if (s_pCurBlock == PC_GETBLOCK(pexblock->startpc))
-			continue;
-		u32 blockend = pexblock->startpc + pexblock->size * 4;
-		if (pexblock->startpc >= addr && pexblock->startpc < addr + size * 4
-		 || pexblock->startpc < addr && blockend > addr) {
-			if( !IsDevBuild )
-				Console.Error( "Impossible block clearing failure" );
-			else
+	// Walking every block is too slow to do on each clear in release builds.
+	if (IsDevBuild) {
+		for (iter = recBlocks.Begin(); iter != recBlocks.End(); ++iter) {
+			BASEBLOCKEX* pexblock = &iter->second;
+			if (s_pCurBlock == PC_GETBLOCK(pexblock->startpc))
+				continue;
+			u32 blockend = pexblock->startpc + pexblock->size * 4;
+			if (pexblock->startpc >= addr && pexblock->startpc < addr + size * 4
+			 || pexblock->startpc < addr && blockend > addr)
 				pxFailDev( "Impossible block clearing failure" );
 		}
 	}
@@ -1177,6 +1221,13 @@ static void iBranchTest(u32 newpc)
 		xMOV(eax, ptr[&cpuRegs.cycle]);
 		xADD(eax, eeScaleBlockCycles());
 		xMOV(ptr[&cpuRegs.cycle], eax); // update cycles
+
+		// The threaded IOP is waiting on the EE (see IOP_Thread::SyncWithEE)
+		if (THREAD_IOP) {
+			xCMP(ptr32[(u32*)&iopThread.eeSyncRequest], 0);
+			xJNZ( DispatcherEvent );
+		}
+
 		xSUB(eax, ptr[&g_nextEventCycle]);
 
 		if (newpc == 0xffffffff)
@@ -1396,23 +1447,28 @@ static void __fastcall recRecompile( const u32 startpc )
 	u32 willbranch3 = 0;
 	u32 usecop2;
 
+	g_eeProfileZone = GPZ_Recompiler;	// JITCompile sets it back before entering the block
+
 #ifdef PCSX2_DEBUG
     if (dumplog & 4) iDumpRegisters(startpc, 0);
 #endif
 
 	pxAssert( startpc );
 
-	// if recPtr reached the mem limit reset whole mem
-	if (recPtr >= (recMem->GetPtrEnd() - _64kb)) {
-		AtomicExchange( eeRecNeedsReset, true );
-	}
-	else if ((recConstBufPtr - recConstBuf) >= RECCONSTBUF_SIZE - 64) {
+	// iCore's register allocator is shared with the IOP rec, which may be compiling
+	// on its own thread.
+	ScopedLock lock( THREAD_IOP ? &iopThread.mtxRecompile : NULL );
+
+	if ((recConstBufPtr - recConstBuf) >= RECCONSTBUF_SIZE - 64) {
 		Console.WriteLn("EE recompiler stack reset");
 		AtomicExchange( eeRecNeedsReset, true );
 	}
 
 	if (eeRecNeedsReset) recResetRaw();
 
+	// if recPtr reached the end of its region, move on to the next one
+	if (recPtr >= (recRegionEnd - _64kb)) recReclaimRegion();
+
 	xSetPtr( recPtr );
 	recPtr = xGetAlignedCallTarget();
 
@@ -1559,9 +1615,11 @@ static void __fastcall recRecompile( const u32 startpc )
 StartRecomp:
 
 	// The idea here is that as long as a loop doesn't write to a register it's already read
-	// (excepting registers initialised with constants or memory loads) or use any instructions
-	// which alter the machine state apart from registers, it will do the same thing on every
-	// iteration.
+	// (excepting registers written earlier in the same iteration, or initialised with constants
+	// or values derived from them) or use any instructions which alter the machine state apart
+	// from registers, it will do the same thing on every iteration.  That covers the common
+	// hardware polling loops (D_STAT, CHCR, VIF/GIF STAT, SIF flags, a RAM word filled in by
+	// DMA...), which can only see a different value once some scheduled event has run.
 	// TODO: special handling for counting loops.  God of war wastes time in a loop which just
 	// counts to some large number and does nothing else, many other games use a counter as a
 	// timeout on a register read.  AFAICS the only way to optimise this for non-const cases
@@ -1571,70 +1629,61 @@ StartRecomp:
 	if (s_branchTo == startpc) {
 		s_nBlockFF = true;
 
-		u32 reads = 0, loads = 1;
+		// reads  - registers read before being written in this iteration (loop-carried)
+		// writes - registers written so far in this iteration
+		// consts - registers holding a value that doesn't depend on any loop-carried state
+		u32 reads = 0, writes = 1, consts = 1;
 
 		for (i = startpc; i < s_nEndBlock; i += 4) {
 			if (i == s_nEndBlock - 8)
 				continue;
 			cpuRegs.code = *(u32*)PSM(i);
+
+			u32 src, dst;
+
 			// nop
 			if (cpuRegs.code == 0)
 				continue;
 			// cache, sync
 			else if (_Opcode_ == 057 || _Opcode_ == 0 && _Funct_ == 017)
 				continue;
-			// imm arithmetic
-			else if ((_Opcode_ & 070) == 010 || (_Opcode_ & 076) == 030)
+			// imm arithmetic, loads
+			else if ((_Opcode_ & 070) == 010 || (_Opcode_ & 076) == 030 ||
+				(_Opcode_ & 070) == 040 || (_Opcode_ & 076) == 032 || _Opcode_ == 036 || _Opcode_ == 067)
 			{
-				if (loads & 1 << _Rs_) {
-					loads |= 1 << _Rt_;
-					continue;
-				}
-				else
-					reads |= 1 << _Rs_;
-				if (reads & 1 << _Rt_) {
-					s_nBlockFF = false;
-					break;
-				}
+				src = 1 << _Rs_;
+				dst = 1 << _Rt_;
 			}
-			// common register arithmetic instructions
-			else if (_Opcode_ == 0 && (_Funct_ & 060) == 040 && (_Funct_ & 076) != 050)
+			// common register arithmetic instructions, shifts
+			else if (_Opcode_ == 0 && (((_Funct_ & 060) == 040 && (_Funct_ & 076) != 050) ||
+				(((_Funct_ & 070) == 000 || (_Funct_ & 074) == 024 || (_Funct_ & 070) == 070) && (_Funct_ & 3) != 1)))
 			{
-				if (loads & 1 << _Rs_ && loads & 1 << _Rt_) {
-					loads |= 1 << _Rd_;
-					continue;
-				}
-				else
-					reads |= 1 << _Rs_ | 1 << _Rt_;
-				if (reads & 1 << _Rd_) {
-					s_nBlockFF = false;
-					break;
-				}
-			}
-			// loads
-			else if ((_Opcode_ & 070) == 040 || (_Opcode_ & 076) == 032 || _Opcode_ == 067)
-			{
-				if (loads & 1 << _Rs_) {
-					loads |= 1 << _Rt_;
-					continue;
-				}
-				else
-					reads |= 1 << _Rs_;
-				if (reads & 1 << _Rt_) {
-					s_nBlockFF = false;
-					break;
-				}
+				src = 1 << _Rs_ | 1 << _Rt_;
+				dst = 1 << _Rd_;
 			}
 			// mfc*, cfc*
 			else if ((_Opcode_ & 074) == 020 && _Rs_ < 4)
 			{
-				loads |= 1 << _Rt_;
+				src = 0;
+				dst = 1 << _Rt_;
 			}
 			else
 			{
 				s_nBlockFF = false;
 				break;
 			}
+
+			reads |= src & ~writes;
+			writes |= dst;
+
+			if (!(src & ~consts))
+				consts |= dst;
+			else if (reads & dst) {
+				s_nBlockFF = false;
+				break;
+			}
+			else
+				consts &= ~dst | 1;
 		}
 	}
 
@@ -1819,11 +1868,10 @@ StartRecomp:
 	s_pCurBlockEx->size = (pc-startpc)>>2;
 
 	if (HWADDR(pc) <= Ps2MemSize::MainRam) {
-		BASEBLOCKEX *oldBlock;
-		int i;
+		BaseBlocks::iterator iter = recBlocks.UpperBound(HWADDR(pc) - 4);
 
-		i = recBlocks.LastIndex(HWADDR(pc) - 4);
-		while (oldBlock = recBlocks[i--]) {
+		while (iter != recBlocks.Begin()) {
+			BASEBLOCKEX* oldBlock = &(--iter)->second;
 			if (oldBlock == s_pCurBlockEx)
 				continue;
 			if (oldBlock->startpc >= HWADDR(pc))
@@ -1899,6 +1947,9 @@ StartRecomp:
 	pxAssert(xGetPtr() - recPtr < _64kb);
 	s_pCurBlockEx->x86size = xGetPtr() - recPtr;
 
+	if( EmuConfig.Profiler.Enabled && EmuConfig.Profiler.RecBlocks_EE )
+		ProfilerRegisterBlock( recPtr, s_pCurBlockEx->x86size, "EE:%08x", startpc );
+
 	recPtr = xGetPtr();
 
 	pxAssert( (g_cpuHasConstReg&g_cpuFlushedConstReg) == g_cpuHasConstReg );
@@ -18,9 +18,12 @@
 
 #include "Common.h"
 #include "vtlb.h"
+#include "SamplProf.h"
+#include "Cache.h"
 
 #include "iCore.h"
 #include "iR5900.h"
+#include "MTIOP.h"
 
 using namespace vtlb_private;
 using namespace x86Emitter;
@@ -171,6 +174,159 @@ namespace vtlb_private
 		return writeback;
 	}
 
+	// ------------------------------------------------------------------------
+	// Fastmem probe, emitted ahead of DynGen_PrepRegs.  kuseg/kseg0 addresses that land in
+	// main RAM are rebased straight onto eeMem->Main (in ecx) and jump over the vmap lookup
+	// and indirect dispatch; anything else falls through to the regular vtlb sequence.
+	// Returns the jump's rel32 for DynGen_FastmemJoin, or NULL if fastmem is disabled.
+	//
+	static s32* DynGen_FastmemProbe()
+	{
+		// Cache emulation needs every access to see the cache probe below.
+		if( !EmuConfig.Cpu.Recompiler.EnableFastmem || CHECK_CACHE ) return NULL;
+
+		xMOV( eax, ecx );
+		xAND( eax, VTLB_FASTMEM_MASK );
+		xCMP( eax, ptr32[&vtlbdata.fastmem_limit] );
+		xForwardJAE32 vtlbpath;
+
+		xLEA( ecx, ptr[eeMem->Main + eax] );
+		xForwardJump32 direct;
+
+		vtlbpath.SetTarget();
+		return ((s32*)direct.BasePtr) - 1;
+	}
+
+	// Targets the fastmem jump at the direct access code (which must follow immediately).
+	static void DynGen_FastmemJoin( s32* direct )
+	{
+		if( direct ) *direct = (s8*)xGetPtr() - (s8*)(direct + 1);
+	}
+
+	// ------------------------------------------------------------------------
+	// Miss handlers for the cache probe, indexed the same way as RWFT.
+	static void* const s_CacheHandlers[5][2] =
+	{
+		{ (void*)vtlb_CacheRead8,	(void*)vtlb_CacheWrite8 },
+		{ (void*)vtlb_CacheRead16,	(void*)vtlb_CacheWrite16 },
+		{ (void*)vtlb_CacheRead32,	(void*)vtlb_CacheWrite32 },
+		{ (void*)vtlb_CacheRead64,	(void*)vtlb_CacheWrite64 },
+		{ (void*)vtlb_CacheRead128,	(void*)vtlb_CacheWrite128 },
+	};
+
+	static u32 s_cacheAddr;		// guest address of the access being probed
+
+	// ------------------------------------------------------------------------
+	// EE data cache probe, emitted between the indirect dispatch and the direct access code
+	// (eax = vmv, ecx = ppf).  On pages the TLB maps as cached, the access is checked inline
+	// against both ways of its pCache set: hits point ecx at the cached copy (flagging the line
+	// dirty for stores) and fall into the direct access code, while misses, which may need a
+	// line fill or a dirty eviction, call out to Cache.cpp.  128 bit accesses always call out,
+	// since cache lines aren't 16 byte aligned.
+	// Returns the miss path's exit jump for DynGen_CacheJoin, or NULL if the cache is
+	// not emulated.
+	//
+	static s32* DynGen_CacheProbe( int mode, u32 bits, bool sign )
+	{
+		if( !CHECK_CACHE ) return NULL;
+
+		int szidx;
+		switch( bits )
+		{
+			case 8:		szidx=0;	break;
+			case 16:	szidx=1;	break;
+			case 32:	szidx=2;	break;
+			case 64:	szidx=3;	break;
+			case 128:	szidx=4;	break;
+			jNO_DEFAULT;
+		}
+
+		xMOV( ebx, ecx );
+		xSUB( ebx, eax );
+		xMOV( ptr32[&s_cacheAddr], ebx );
+		xSHR( ebx, VTLB_PAGE_BITS );
+		xBT( ptr[vtlbdata.cachemap], ebx );
+		xForwardJAE32 uncachedPage;		// carry clear: page isn't cached
+
+		xTEST( ptr8[((u8*)&cpuRegs.CP0.n.Config) + 2], 1 );
+		xForwardJZ32 cacheDisabled;
+
+		s32* toDirect = NULL;
+
+		if( bits != 128 )
+		{
+			// Tags hold the physical page (as computed by getFreeCache) plus flags.
+			xMOVZX( eax, al );
+			xSUB( ecx, eax );
+			xADD( ecx, 0x80000000 );
+			xAND( ecx, ~0xfff );
+			xOR( ecx, VALID_FLAG );
+
+			// eax = set index * sizeof(_cacheS)
+			xMOV( eax, ptr32[&s_cacheAddr] );
+			xSHR( eax, 6 );
+			xAND( eax, 0x3f );
+			xMUL( eax, eax, sizeof(_cacheS) );
+
+			xMOV( ebx, ptr32[eax + &pCache[0].tag[0]] );
+			xXOR( ebx, ecx );
+			xTEST( ebx, ~0xfff | VALID_FLAG );
+			xForwardJZ8 way0;
+
+			xMOV( ebx, ptr32[eax + &pCache[0].tag[1]] );
+			xXOR( ebx, ecx );
+			xTEST( ebx, ~0xfff | VALID_FLAG );
+			xForwardJNZ8 wayMiss;
+
+			if( mode ) xOR( ptr32[eax + &pCache[0].tag[1]], DIRTY_FLAG );
+			xADD( eax, sizeof(pCache[0].data[0]) );
+			xForwardJump8 line;
+
+			way0.SetTarget();
+			if( mode ) xOR( ptr32[eax + &pCache[0].tag[0]], DIRTY_FLAG );
+
+			line.SetTarget();
+			xMOV( ecx, ptr32[&s_cacheAddr] );
+			xAND( ecx, 0x3f );
+			xLEA( ecx, ptr[eax + ecx + &pCache[0].data[0]] );
+			xForwardJump32 hit;
+			toDirect = ((s32*)hit.BasePtr) - 1;
+
+			wayMiss.SetTarget();
+		}
+
+		// [ecx is address, edx is data]
+		xMOV( ecx, ptr32[&s_cacheAddr] );
+		xCALL( s_CacheHandlers[szidx][mode] );
+
+		if( !mode && bits < 32 )
+		{
+			if( bits == 8 )
+			{
+				if( sign )	xMOVSX( eax, al );
+				else		xMOVZX( eax, al );
+			}
+			else
+			{
+				if( sign )	xMOVSX( eax, ax );
+				else		xMOVZX( eax, ax );
+			}
+		}
+		xForwardJump32 done;
+
+		uncachedPage.SetTarget();
+		cacheDisabled.SetTarget();
+		if( toDirect ) *toDirect = (s8*)xGetPtr() - (s8*)(toDirect + 1);
+
+		return ((s32*)done.BasePtr) - 1;
+	}
+
+	// Targets the cache probe's miss exit past the direct access code.
+	static void DynGen_CacheJoin( s32* done )
+	{
+		if( done ) *done = (s8*)xGetPtr() - (s8*)(done + 1);
+	}
+
 	// ------------------------------------------------------------------------
 	static void DynGen_DirectRead( u32 bits, bool sign )
 	{
@@ -278,14 +434,18 @@ static void DynGen_IndirectDispatch( int mode, int bits, bool sign = false )
 	xJS( GetIndirectDispatcherPtr( mode, szidx, sign ) );
 }
 
-// One-time initialization procedure.  Multiple subsequent calls during the lifespan of the
-// process will be ignored.
+// Generates the indirect dispatchers.  Subsequent calls are ignored unless the guest profiler
+// has been switched on or off since, in which case they're regenerated in place (callers
+// must make sure no recompiled code is running).
 //
 void vtlb_dynarec_init()
 {
-	static bool hasBeenCalled = false;
-	if (hasBeenCalled) return;
-	hasBeenCalled = true;
+	ScopedLock lock( THREAD_IOP ? &iopThread.mtxRecompile : NULL );
+
+	static int generatedFor = -1;
+	int profile = GuestProfiler_IsEnabled();
+	if (generatedFor == profile) return;
+	generatedFor = profile;
 
 	// In case init gets called multiple times:
 	HostSys::MemProtectStatic( m_IndirectDispatchers, PageAccess_ReadWrite() );
@@ -307,7 +467,9 @@ void vtlb_dynarec_init()
 
 				// jump to the indirect handler, which is a __fastcall C++ function.
 				// [ecx is address, edx is data]
+				if (profile) xMOV( ptr8[(u8*)&g_eeProfileZone], GPZ_Memory );
 				xCALL( ptr32[(eax*4) + vtlbdata.RWFT[bits][mode]] );
+				if (profile) xMOV( ptr8[(u8*)&g_eeProfileZone], GPZ_Code );
 
 				if (!mode)
 				{
@@ -341,10 +503,14 @@ void vtlb_DynGenRead64(u32 bits)
 {
 	jASSUME( bits == 64 || bits == 128 );
 
+	s32* fastmem = DynGen_FastmemProbe();
 	uptr* writeback = DynGen_PrepRegs();
 
 	DynGen_IndirectDispatch( 0, bits );
+	DynGen_FastmemJoin( fastmem );
+	s32* cached = DynGen_CacheProbe( 0, bits, false );
 	DynGen_DirectRead( bits, false );
+	DynGen_CacheJoin( cached );
 
 	*writeback = (uptr)xGetPtr();		// return target for indirect's call/ret
 }
@@ -357,10 +523,14 @@ void vtlb_DynGenRead32(u32 bits, bool sign)
 {
 	jASSUME( bits <= 32 );
 
+	s32* fastmem = DynGen_FastmemProbe();
 	uptr* writeback = DynGen_PrepRegs();
 
 	DynGen_IndirectDispatch( 0, bits, sign && bits < 32 );
+	DynGen_FastmemJoin( fastmem );
+	s32* cached = DynGen_CacheProbe( 0, bits, sign );
 	DynGen_DirectRead( bits, sign );
+	DynGen_CacheJoin( cached );
 
 	*writeback = (uptr)xGetPtr();
 }
@@ -372,7 +542,14 @@ void vtlb_DynGenRead64_Const( u32 bits, u32 addr_const )
 {
 	u32 vmv_ptr = vtlbdata.vmap[addr_const>>VTLB_PAGE_BITS];
 	s32 ppf = addr_const + vmv_ptr;
-	if( ppf >= 0 )
+	if( ppf >= 0 && CHECK_CACHE )
+	{
+		// Cached-ness is only known at runtime, so take the probing path.
+		iFlushCall(FLUSH_FULLVTLB);
+		xMOV( ecx, addr_const );
+		vtlb_DynGenRead64( bits );
+	}
+	else if( ppf >= 0 )
 	{
 		switch( bits )
 		{
@@ -418,7 +595,13 @@ void vtlb_DynGenRead32_Const( u32 bits, bool sign, u32 addr_const )
 {
 	u32 vmv_ptr = vtlbdata.vmap[addr_const>>VTLB_PAGE_BITS];
 	s32 ppf = addr_const + vmv_ptr;
-	if( ppf >= 0 )
+	if( ppf >= 0 && CHECK_CACHE )
+	{
+		iFlushCall(FLUSH_FULLVTLB);
+		xMOV( ecx, addr_const );
+		vtlb_DynGenRead32( bits, sign );
+	}
+	else if( ppf >= 0 )
 	{
 		switch( bits )
 		{
@@ -491,10 +674,14 @@ void vtlb_DynGenRead32_Const( u32 bits, bool sign, u32 addr_const )
 
 void vtlb_DynGenWrite(u32 sz)
 {
+	s32* fastmem = DynGen_FastmemProbe();
 	uptr* writeback = DynGen_PrepRegs();
 
 	DynGen_IndirectDispatch( 1, sz );
+	DynGen_FastmemJoin( fastmem );
+	s32* cached = DynGen_CacheProbe( 1, sz, false );
 	DynGen_DirectWrite( sz );
+	DynGen_CacheJoin( cached );
 
 	*writeback = (uptr)xGetPtr();
 }
@@ -508,7 +695,13 @@ void vtlb_DynGenWrite_Const( u32 bits, u32 addr_const )
 {
 	u32 vmv_ptr = vtlbdata.vmap[addr_const>>VTLB_PAGE_BITS];
 	s32 ppf = addr_const + vmv_ptr;
-	if( ppf >= 0 )
+	if( ppf >= 0 && CHECK_CACHE )
+	{
+		iFlushCall(FLUSH_FULLVTLB);
+		xMOV( ecx, addr_const );
+		vtlb_DynGenWrite( bits );
+	}
+	else if( ppf >= 0 )
 	{
 		switch(bits)
 		{
@@ -22,6 +22,19 @@
 // Micro VU - Main Functions
 //------------------------------------------------------------------
 
+// Per-word multipliers for the micro memory hash (see mVUupdateMicroHash)
+static u64 mVUhashKey[mProgSize];
+
+static void mVUinitHashKeys() {
+	u64 seed = 0x9e3779b97f4a7c15ULL;
+	for (u32 i = 0; i < mProgSize; i++) {
+		u64 z = (seed += 0x9e3779b97f4a7c15ULL);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		mVUhashKey[i] = (z ^ (z >> 31)) | 1;
+	}
+}
+
 static __fi void mVUthrowHardwareDeficiency(const wxChar* extFail, int vuIndex) {
 	throw Exception::HardwareDeficiency()
 		.SetDiagMsg(pxsFmt(L"microVU%d recompiler init failed: %s is not available.", vuIndex, extFail))
@@ -48,6 +61,7 @@ void mVUinit(microVU& mVU, uint vuIndex) {
 	if(!x86caps.hasStreamingSIMD2Extensions) mVUthrowHardwareDeficiency( L"SSE2", vuIndex );
 
 	memzero(mVU.prog);
+	mVUinitHashKeys();
 
 	mVU.index			=  vuIndex;
 	mVU.cop2			=  0;
@@ -60,6 +74,7 @@ void mVUinit(microVU& mVU, uint vuIndex) {
 	mVU.dispCache		= NULL;
 	mVU.startFunct		= NULL;
 	mVU.exitFunct		= NULL;
+	mVU.profPtr			= NULL;
 
 	mVUreserveCache(mVU);
 
@@ -94,6 +109,7 @@ void mVUreset(microVU& mVU, bool resetReserve) {
 	mVU.prog.cur		= NULL;
 	mVU.prog.total		=  0;
 	mVU.prog.curFrame	=  0;
+	mVU.prog.microHashDirty = 0;
 
 	// Setup Dynarec Cache Limits for Each Program
 	u8* z = mVU.cache;
@@ -136,6 +152,8 @@ void mVUclose(microVU& mVU) {
 
 // Clears Block Data in specified range
 __fi void mVUclear(mV, u32 addr, u32 size) {
+	// Callers clear before writing, so the hash can only be updated on the next search
+	mVU.prog.microHashDirty = min(mVU.prog.microHashDirty, (addr & (mVU.microMemSize-1)) / 4);
 	if(!mVU.prog.cleared) {
 		mVU.prog.cleared = 1;		// Next execution searches/creates a new microprogram
 		memzero(mVU.prog.lpState); // Clear pipeline state
@@ -185,6 +203,7 @@ __ri microProgram* mVUcreateProg(microVU& mVU, int startPC) {
 __ri void mVUcacheProg(microVU& mVU, microProgram& prog) {
 	if (!mVU.index)	memcpy_const(prog.data, mVU.regs().Micro, 0x1000);
 	else			memcpy_const(prog.data, mVU.regs().Micro, 0x4000);
+	prog.rangeHashValid = false;
 	mVUdumpProg(mVU, prog);
 }
 
@@ -232,6 +251,59 @@ __ri bool mVUcmpPartial(microVU& mVU, microProgram& prog) {
 	return 1;
 }
 
+// The micro memory hash lets mVUsearchProg skip candidate programs without comparing
+// them.  Each word contributes Micro[i] * mVUhashKey[i], so the hash of any range of
+// words is the difference of two running totals in microHash[].  The write paths only
+// record the lowest word they touched (via mVUclear); the totals past it are redone
+// once, on the next search.
+__fi void mVUupdateMicroHash(microVU& mVU) {
+	u32 i = mVU.prog.microHashDirty;
+	if (i >= mVU.progSize) return;
+	const u32* micro = (u32*)mVU.regs().Micro;
+	u64*       hash  = mVU.prog.microHash;
+	for ( ; i < mVU.progSize; i++) {
+		hash[i+1] = hash[i] + micro[i] * mVUhashKey[i];
+	}
+	mVU.prog.microHashDirty = mVU.progSize;
+}
+
+// Gets the words covered by a range (the same bytes mVUcmpPartial compares)
+static __fi bool mVUrangeWords(microVU& mVU, const microRange& range, u32& first, u32& last) {
+	first = max(range.start, 0) / 4;
+	last  = min(range.end + 8, (s32)mVU.microMemSize) / 4;
+	return (s32)last > (s32)first;
+}
+
+// Hash of the program's compiled ranges in its cached copy of micro memory
+static u64 mVUprogHash(microVU& mVU, microProgram& prog) {
+	if (!prog.rangeHashValid) {
+		u64 hash = 0;
+		u32 first, last;
+		deque<microRange>::const_iterator it(prog.ranges->begin());
+		for ( ; it != prog.ranges->end(); ++it) {
+			if (!mVUrangeWords(mVU, it[0], first, last)) continue;
+			for (u32 i = first; i < last; i++) {
+				hash += prog.data[i] * mVUhashKey[i];
+			}
+		}
+		prog.rangeHash      = hash;
+		prog.rangeHashValid = true;
+	}
+	return prog.rangeHash;
+}
+
+// Hash of the program's compiled ranges in the current micro memory
+static __fi u64 mVUmicroHash(microVU& mVU, microProgram& prog) {
+	u64 hash = 0;
+	u32 first, last;
+	deque<microRange>::const_iterator it(prog.ranges->begin());
+	for ( ; it != prog.ranges->end(); ++it) {
+		if (!mVUrangeWords(mVU, it[0], first, last)) continue;
+		hash += mVU.prog.microHash[last] - mVU.prog.microHash[first];
+	}
+	return hash;
+}
+
 // Compare Cached microProgram to mVU.regs().Micro
 __fi bool mVUcmpProg(microVU& mVU, microProgram& prog, const bool cmpWholeProg) {
 	if ((cmpWholeProg && !memcmp_mmx((u8*)prog.data, mVU.regs().Micro, mVU.microMemSize))
@@ -244,35 +316,62 @@ __fi bool mVUcmpProg(microVU& mVU, microProgram& prog, const bool cmpWholeProg)
 	return 0;
 }
 
+// Makes a new program instance from the current micro memory and compiles its entry block
+static void* mVUnewProg(microVU& mVU, u32 startPC, uptr pState, bool optTier) {
+	microProgramQuick& quick = mVU.prog.quick[startPC/8];
+	mVU.prog.cleared	= 0;
+	mVU.prog.isSame		= 1;
+	mVU.prog.cur		= mVUcreateProg(mVU,  startPC/8);
+	mVU.prog.cur->optTier = optTier;
+	void* entryPoint	= mVUblockFetch(mVU,  startPC, pState);
+	quick.block			= mVU.prog.cur->block[startPC/8];
+	quick.prog			= mVU.prog.cur;
+	mVU.prog.prog[startPC/8]->push_front(mVU.prog.cur);
+	return entryPoint;
+}
+
+// Counts executions of a program, and once it's hot recompiles it with the optimization
+// tier (returns the entry-point of the new program, or NULL to keep running 'prog').
+// The new program goes to the front of the list, so later searches find it first; the old
+// one is kept since recompiled code still running may reference its blocks.
+static __fi void* mVUtierUp(microVU& mVU, microProgram& prog, u32 startPC, uptr pState) {
+	const microRegInfo& pS = *(microRegInfo*)pState;
+	pxAssertDev(prog.optTier || (!(pS.flagInfo&1) && !pS.vi15 && !pS.vi15v),
+		pxsFmt("microVU%d: optimization tier pipeline state entering untiered program [%03d]", mVU.index, prog.idx));
+	if (!CHECK_VU_OPTTIER || prog.optTier || prog.execCount >= mVUoptTierThreshold) return NULL;
+	if (++prog.execCount < mVUoptTierThreshold) return NULL;
+	DevCon.WriteLn(mVU.index ? Color_Orange : Color_Magenta, "microVU%d: Prog [%03d] is hot, recompiling with optimization tier",
+				   mVU.index, prog.idx);
+	return mVUnewProg(mVU, startPC, pState, true);
+}
+
 // Searches for Cached Micro Program and sets prog.cur to it (returns entry-point to program)
 _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState) {
 	microVU& mVU = mVUx;
 	microProgramQuick& quick = mVU.prog.quick[startPC/8];
 	microProgramList*  list  = mVU.prog.prog [startPC/8];
 	if(!quick.prog) { // If null, we need to search for new program
+		mVUupdateMicroHash(mVU);
 		deque<microProgram*>::iterator it(list->begin());
 		for ( ; it != list->end(); ++it) {
+			// Only programs whose ranges hash the same are worth a compare
+			if (mVUprogHash(mVU, *it[0]) != mVUmicroHash(mVU, *it[0])) continue;
 			if (mVUcmpProg(mVU, *it[0], 0)) {
 				quick.block = it[0]->block[startPC/8];
 				quick.prog  = it[0];
 				list->erase(it);
 				list->push_front(quick.prog);
+				if (void* entryPoint = mVUtierUp(mVU, *quick.prog, startPC, pState)) return entryPoint;
 				return mVUentryGet(mVU, quick.block, startPC, pState);
 			}
 		}
 
 		// If cleared and program not found, make a new program instance
-		mVU.prog.cleared	= 0;
-		mVU.prog.isSame		= 1;
-		mVU.prog.cur		= mVUcreateProg(mVU,  startPC/8);
-		void* entryPoint	= mVUblockFetch(mVU,  startPC, pState);
-		quick.block			= mVU.prog.cur->block[startPC/8];
-		quick.prog			= mVU.prog.cur;
-		list->push_front(mVU.prog.cur);
 		//mVUprintUniqueRatio(mVU);
-		return entryPoint;
+		return mVUnewProg(mVU, startPC, pState, false);
 	}
 	// If list.quick, then we've already found and recompiled the program ;)
+	if (void* entryPoint = mVUtierUp(mVU, *quick.prog, startPC, pState)) return entryPoint;
 	mVU.prog.isSame	= -1;
 	mVU.prog.cur	=  quick.prog;
 	return mVUentryGet(mVU, quick.block, startPC, pState);
@@ -31,6 +31,7 @@ using namespace x86Emitter;
 #include "iR5900.h"
 #include "R5900OpcodeTables.h"
 #include "System/RecTypes.h"
+#include "SamplProf.h"
 #include "x86emitter/x86emitter.h"
 #include "microVU_Misc.h"
 #include "microVU_IR.h"
@@ -41,12 +42,105 @@ struct microBlockLink {
 	microBlockLink*	next;
 };
 
+// Hash of the pipeline state fields a quick (simple) search compares
+// Note: vi15/vi15v are always 0 unless the state comes from a program compiled with doConstProp
+static __fi u32 mVUquickHash(const microRegInfo& pState) {
+	u32 hash = pState.quick32[0] * 0x9e3779b1 ^ pState.quick32[1];
+	hash ^= (pState.vi15 | (pState.vi15v << 16)) * 0x85ebca6b;
+	hash ^= hash >> 15;
+	hash *= 0x2c1b3c6d;
+	return hash ^ (hash >> 12);
+}
+
+// Hash of the whole pipeline state (for blocks that need an exact match)
+static __fi u32 mVUfullHash(const microRegInfo& pState) {
+	u32 hash = 2166136261u;
+	for (uint i = 0; i < sizeof(microRegInfo)/4; i++) {
+		hash = (hash ^ pState.full32[i]) * 16777619u;
+	}
+	return hash ^ (hash >> 16);
+}
+
+// Open-addressed index of the blocks in one of microBlockManager's lists, keyed by the
+// hash of the pipeline state fields that list's search compares.  The blocks themselves
+// stay where they were allocated (compiled code and jump caches hold pointers to them),
+// so the table only holds pointers to them.
+class microBlockIndex {
+private:
+	struct Entry {
+		u32			hash;
+		microBlock*	block;
+	};
+	Entry* table;
+	u32 mask;	// table size - 1 (size is a power of 2)
+	u32 count;
+
+	void grow() {
+		u32    oldSize  = table ? mask + 1 : 0;
+		Entry* oldTable = table;
+		mask  = oldSize ? (oldSize * 2) - 1 : 7;
+		table = new Entry[mask + 1];
+		memset(table, 0, (mask + 1) * sizeof(Entry));
+		for (u32 i = 0; i < oldSize; i++) {
+			if (oldTable[i].block) insert(oldTable[i].hash, oldTable[i].block);
+		}
+		safe_delete_array(oldTable);
+	}
+	void insert(u32 hash, microBlock* block) {
+		u32 i = hash & mask;
+		while (table[i].block) i = (i + 1) & mask;
+		table[i].hash  = hash;
+		table[i].block = block;
+	}
+
+public:
+	microBlockIndex()  { table = NULL; mask = count = 0; }
+	~microBlockIndex() { reset(); }
+	void reset() {
+		safe_delete_array(table);
+		mask = count = 0;
+	}
+	void add(u32 hash, microBlock* block) {
+		if (!table || (count + 1) * 2 > mask + 1) grow();
+		insert(hash, block);
+		count++;
+	}
+	// Calls match(block) for each block with the given hash, returning the first one it accepts
+	template<typename T> __fi microBlock* find(u32 hash, const T& match) const {
+		if (!table) return NULL;
+		for (u32 i = hash & mask; table[i].block; i = (i + 1) & mask) {
+			if (table[i].hash == hash && match(table[i].block)) return table[i].block;
+		}
+		return NULL;
+	}
+};
+
 class microBlockManager {
 private:
 	microBlockLink* qBlockList, *qBlockEnd; // Quick Search
 	microBlockLink* fBlockList, *fBlockEnd; // Full  Search
+	microBlockIndex qBlockIndex, fBlockIndex; // Hash lookup into the above lists
 	int qListI, fListI;
 
+	struct matchQuick {
+		const microRegInfo* pState;
+		matchQuick(const microRegInfo* state) : pState(state) {}
+		__fi bool operator()(const microBlock* block) const {
+			if (block->pState.quick32[0] != pState->quick32[0]) return false;
+			if (block->pState.quick32[1] != pState->quick32[1]) return false;
+			if (block->pState.vi15  != pState->vi15)  return false;
+			if (block->pState.vi15v != pState->vi15v) return false;
+			return true;
+		}
+	};
+	struct matchFull {
+		const microRegInfo* pState;
+		matchFull(const microRegInfo* state) : pState(state) {}
+		__fi bool operator()(const microBlock* block) const {
+			return mVUquickSearch((void*)pState, (void*)&block->pState, sizeof(microRegInfo));
+		}
+	};
+
 public:
 	inline int getFullListCount() const { return fListI; }
 	microBlockManager() {
@@ -68,6 +162,8 @@ public:
 			linkI = linkI->next;
 			_aligned_free(freeI);
 		}
+		qBlockIndex.reset();
+		fBlockIndex.reset();
 		qListI = fListI = 0;
 		qBlockEnd = qBlockList = NULL;
 		fBlockEnd = fBlockList = NULL;
@@ -75,7 +171,7 @@ public:
 	microBlock* add(microBlock* pBlock) {
 		microBlock* thisBlock = search(&pBlock->pState);
 		if (!thisBlock) {
-			u8  doFF    = doFullFlagOpt && (pBlock->pState.flagInfo&1);
+			u8  doFF    = pBlock->pState.flagInfo&1; // Only set with doFullFlagOpt
 			u8  fullCmp = pBlock->pState.needExactMatch || doFF;
 			if (fullCmp) fListI++; else qListI++;
 
@@ -95,27 +191,20 @@ public:
 
 			memcpy_const(&newBlock->block, pBlock, sizeof(microBlock));
 			thisBlock =  &newBlock->block;
+
+			if (fullCmp) fBlockIndex.add(mVUfullHash (thisBlock->pState), thisBlock);
+			else		 qBlockIndex.add(mVUquickHash(thisBlock->pState), thisBlock);
 		}
 		return thisBlock;
 	}
 	__ri microBlock* search(microRegInfo* pState) {
-		u8  doFF = doFullFlagOpt && (pState->flagInfo&1);
+		u8  doFF = pState->flagInfo&1; // Only set with doFullFlagOpt
 		if (pState->needExactMatch || doFF) { // Needs Detailed Search (Exact Match of Pipeline State)
-			for(microBlockLink* linkI = fBlockList; linkI != NULL; linkI = linkI->next) {
-				if (mVUquickSearch((void*)pState, (void*)&linkI->block.pState, sizeof(microRegInfo)))
-					return &linkI->block;
-			}
+			return fBlockIndex.find(mVUfullHash(*pState), matchFull(pState));
 		}
 		else { // Can do Simple Search (Only Matches the Important Pipeline Stuff)
-			for(microBlockLink* linkI = qBlockList; linkI != NULL; linkI = linkI->next) {
-				if (linkI->block.pState.quick32[0] != pState->quick32[0]) continue;
-				if (linkI->block.pState.quick32[1] != pState->quick32[1]) continue;
-				if (doConstProp && (linkI->block.pState.vi15  != pState->vi15))  continue;
-				if (doConstProp && (linkI->block.pState.vi15v != pState->vi15v)) continue;
-				return &linkI->block;
-			}
+			return qBlockIndex.find(mVUquickHash(*pState), matchQuick(pState));
 		}
-		return NULL;
 	}
 	void printInfo(int pc, bool printQuick) {
 		int listI = printQuick ? qListI : fListI;
@@ -146,8 +235,12 @@ struct microProgram {
 	u32				   data [mProgSize];   // Holds a copy of the VU microProgram
 	microBlockManager* block[mProgSize/2]; // Array of Block Managers
 	deque<microRange>* ranges;			   // The ranges of the microProgram that have already been recompiled
+	u64 rangeHash;		// Hash of data[] over 'ranges' (see mVUprogHash)
+	bool rangeHashValid; // rangeHash is up to date with 'ranges' and data[]
 	u32 startPC; // Start PC of this program
 	int idx;	 // Program index
+	u32 execCount; // Times the program has been entered from mVUsearchProg (until it is promoted)
+	bool optTier;  // Program was compiled with the optimization tier (see mVUoptTierThreshold)
 };
 
 typedef deque<microProgram*> microProgramList;
@@ -170,6 +263,8 @@ struct microProgManager {
 	u8*					x86start;			// Start of program's rec-cache
 	u8*					x86end;				// Limit of program's rec-cache
 	microRegInfo		lpState;			// Pipeline state from where program left off (useful for continuing execution)
+	u64					microHash[mProgSize+1];	// Running hash of mVU.regs().Micro (microHash[n] covers words [0, n))
+	u32					microHashDirty;		// First word of micro memory written since microHash was last updated
 };
 
 static const uint mVUdispCacheSize	= __pagesize; // Dispatcher Cache Size (in bytes)
@@ -217,6 +312,8 @@ struct microVU {
 	u32		q;			  // Holds current Q instance index
 	u32		totalCycles;  // Total Cycles that mVU is expected to run for
 	u32		cycles;		  // Cycles Counter
+	u8*		profPtr;	  // Start of block code not yet named for the profiler (see mVUprofileBlock)
+	u32		profPC;		  // Start PC of the block whose code starts at profPtr
 
 	VURegs& regs() const { return ::vuRegs[index]; }
 
@@ -267,6 +364,10 @@ void sortVector(T& v) {
 	sort(v.begin(), v.end());
 }
 
+// Optimizations only done by the optimization tier (see microVU_Misc.h)
+__fi int  doFullFlagOpt(mV) { return mVU.prog.cur->optTier ? mVUfullFlagOptLimit : 0; }
+__fi bool doConstProp  (mV) { return mVU.prog.cur->optTier; }
+
 // Include all the *.inl files (microVU compiles as 1 Translation Unit)
 #include "microVU_Clamp.inl"
 #include "microVU_Misc.inl"
@@ -517,7 +517,7 @@ __fi void mVUanalyzeNormBranch(mV, int It, bool isBAL) {
 __ri void mVUanalyzeJump(mV, int Is, int It, bool isJALR) {
 	mVUlow.branch = (isJALR) ? 10 : 9;
 	mVUbranchCheck(mVU);
-	if (mVUconstReg[Is].isValid && doConstProp) {
+	if (mVUconstReg[Is].isValid && doConstProp(mVU)) {
 		mVUlow.constJump.isValid  = 1;
 		mVUlow.constJump.regValue = mVUconstReg[Is].regValue;
 		//DevCon.Status("microVU%d: Constant JR/JALR Address Optimization", mVU.index);
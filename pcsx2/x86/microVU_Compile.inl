@@ -58,6 +58,7 @@ void mVUsetupRange(microVU& mVU, s32 pc, bool isStartPC) {
 	elif (mVUrange.end != -1) return; // Above case was true
 
 	mVUcheckIsSame(mVU);
+	mVUcurProg.rangeHashValid = false;
 
 	if (isStartPC) {
 		microRange mRange = {pc, -1};
@@ -508,7 +509,7 @@ void mVUSaveFlags(microVU& mVU,microFlagCycles &mFC, microFlagCycles &mFCBackup)
 	memcpy_fast(&mFCBackup, &mFC, sizeof(microFlagCycles));
 	mVUsetFlags(mVU, mFCBackup);	   // Sets Up Flag instances
 }
-void* mVUcompile(microVU& mVU, u32 startPC, uptr pState) {
+static void* mVUcompileBlock(microVU& mVU, u32 startPC, uptr pState) {
 	
 	microFlagCycles mFC;
 	u8*				thisPtr  = x86Ptr;
@@ -548,8 +549,8 @@ void* mVUcompile(microVU& mVU, u32 startPC, uptr pState) {
 	}
 
 	// Fix up vi15 const info for propagation through blocks
-	mVUregs.vi15  = (doConstProp && mVUconstReg[15].isValid) ? (u16)mVUconstReg[15].regValue : 0;
-	mVUregs.vi15v = (doConstProp && mVUconstReg[15].isValid) ? 1 : 0;
+	mVUregs.vi15  = (doConstProp(mVU) && mVUconstReg[15].isValid) ? (u16)mVUconstReg[15].regValue : 0;
+	mVUregs.vi15v = (doConstProp(mVU) && mVUconstReg[15].isValid) ? 1 : 0;
 		
 	mVUsetFlags(mVU, mFC);	   // Sets Up Flag instances
 	mVUoptimizePipeState(mVU); // Optimize the End Pipeline State for nicer Block Linking
@@ -599,8 +600,44 @@ void* mVUcompile(microVU& mVU, u32 startPC, uptr pState) {
 	return thisPtr;
 }
 
+__fi bool mVUprofileEnabled(microVU& mVU) {
+	return EmuConfig.Profiler.Enabled && (mVU.index ? EmuConfig.Profiler.RecBlocks_VU1 : EmuConfig.Profiler.RecBlocks_VU0);
+}
+
+// Names the code emitted since profPtr after the block it belongs to (for perf).  Branches
+// can compile their target blocks in the middle of the current one, so a block's code may
+// get named in several pieces.
+static void mVUprofileBlock(microVU& mVU) {
+	if (x86Ptr > mVU.profPtr) {
+		ProfilerRegisterBlock(mVU.profPtr, x86Ptr - mVU.profPtr, "mVU%d:%04x [prog %d]",
+							  mVU.index, mVU.profPC, mVU.prog.cur->idx);
+	}
+	mVU.profPtr = x86Ptr;
+}
+
+void* mVUcompile(microVU& mVU, u32 startPC, uptr pState) {
+	if (!mVUprofileEnabled(mVU)) return mVUcompileBlock(mVU, startPC, pState);
+
+	u8* outerPtr = mVU.profPtr;
+	u32 outerPC  = mVU.profPC;
+	if (outerPtr) mVUprofileBlock(mVU); // Ends the piece of the block compiling this one
+	mVU.profPtr = x86Ptr;
+	mVU.profPC  = startPC;
+
+	void* entry = mVUcompileBlock(mVU, startPC, pState);
+
+	mVUprofileBlock(mVU);
+	mVU.profPtr = outerPtr ? x86Ptr : NULL;
+	mVU.profPC  = outerPC;
+	return entry;
+}
+
 // Returns the entry point of the block (compiles it if not found)
 __fi void* mVUentryGet(microVU& mVU, microBlockManager* block, u32 startPC, uptr pState) {
+	// The block lists rely on these only ever being set in optimization tier programs
+	const microRegInfo& pS = *(microRegInfo*)pState;
+	pxAssertDev(mVU.prog.cur->optTier || (!(pS.flagInfo&1) && !pS.vi15 && !pS.vi15v),
+		pxsFmt("microVU%d: optimization tier pipeline state entering untiered program [%03d]", mVU.index, mVU.prog.cur->idx));
 	microBlock* pBlock = block->search((microRegInfo*)pState);
 	if (pBlock) return pBlock->x86ptrStart;
 	else	 {  return mVUcompile(mVU, startPC, pState);}
@@ -101,7 +101,7 @@ __fi void mVUsetFlags(mV, microFlagCycles& mFC) {
 	int xS = 0, xM = 0, xC = 0;
 	u32 ff0=0, ff1=0, ffOn=0, fInfo=0;
 	
-	if (doFullFlagOpt) {
+	if (doFullFlagOpt(mVU)) {
 		ff0   = mVUpBlock->pState.fullFlags0;
 		ff1   = mVUpBlock->pState.fullFlags1;
 		ffOn  = mVUpBlock->pState.flagInfo&1;
@@ -191,7 +191,7 @@ __fi void mVUsetFlags(mV, microFlagCycles& mFC) {
 	mVUregs.flagInfo |= ((__Clip)   ? 0 : (xC << 6));
 	iPC = endPC;
 
-	if (doFullFlagOpt && (mVUregs.flagInfo & 1)) {
+	if (doFullFlagOpt(mVU) && (mVUregs.flagInfo & 1)) {
 		//if (mVUregs.needExactMatch) DevCon.Error("mVU ERROR!!!");
 		int bS[4], bM[4], bC[4];
 		sortFullFlag(mFC.xStatus, bS);
@@ -341,9 +341,9 @@ void mVUflagPass(mV, u32 startPC, u32 sCount = 0, u32 found = 0) {
 }
 
 __fi void checkFFblock(mV, u32 addr, int& ffOpt) {
-	if (ffOpt && doFullFlagOpt) {
+	if (ffOpt && doFullFlagOpt(mVU)) {
 		blockCreate(addr/8);
-		ffOpt = mVUblocks[addr/8]->getFullListCount() <= doFullFlagOpt;
+		ffOpt = mVUblocks[addr/8]->getFullListCount() <= doFullFlagOpt(mVU);
 	}
 }
 
@@ -356,7 +356,7 @@ void mVUsetFlagInfo(mV) {
 		mVUregs.flagInfo		= 0x0;
 		return;
 	}
-	int ffOpt = doFullFlagOpt;
+	int ffOpt = doFullFlagOpt(mVU);
 	if (mVUbranch <= 2) { // B/BAL
 		incPC(-1);
 		mVUflagPass (mVU, branchAddr);
@@ -387,7 +387,7 @@ void mVUsetFlagInfo(mV) {
 		}
 	}
 	else { // JR/JALR
-		if (!doConstProp || !mVUlow.constJump.isValid) { mVUregs.needExactMatch |= 0x7; } 
+		if (!doConstProp(mVU) || !mVUlow.constJump.isValid) { mVUregs.needExactMatch |= 0x7; } 
 		else { mVUflagPass(mVU, (mVUlow.constJump.regValue*8)&(mVU.microMemSize-8)); }
 		mVUregs.needExactMatch &= 0x7;
 	}
@@ -312,13 +312,15 @@ static const bool doCFlagInsts = 1; // Set to 1 to enable multiple clip   flag i
 // Setting one of these to 0 acts as if there is only 1 instance of the
 // corresponding flag, which may be useful when debugging flag pipeline bugs.
 
-static const int doFullFlagOpt = 0; // Set above 0 to enable full flag optimization
+// Full Flag Optimization (optimization tier only)
+static const int mVUfullFlagOptLimit = 2; // Used by doFullFlagOpt(mVU), see microVU.h
 // This attempts to eliminate some flag shuffling at the end of blocks, but
 // can end up creating more recompiled code. The max amount of times this optimization
-// is performed per block can be set by changing the doFullFlagOpt value to be that limit.
-// i.e. setting doFullFlagOpt to 2 will recompile the current block at-most 2 times with
+// is performed per block can be set by changing mVUfullFlagOptLimit.
+// i.e. setting it to 2 will recompile the current block at-most 2 times with
 // the full flag optimization.
-// Note: This optimization doesn't really seem to be benefitial and is buggy...
+// Note: This optimization doesn't seem to be benefitial in general and is buggy in
+// some games, so it's only done for programs recompiled by the optimization tier.
 
 // Branch in Branch Delay Slots
 static const bool doBranchInDelaySlot = 1; // Set to 1 to enable evil-branches
@@ -327,11 +329,11 @@ static const bool doBranchInDelaySlot = 1; // Set to 1 to enable evil-branches
 // cases is tricky and bug prone. If this option is disabled then the second
 // branch is treated as a NOP and effectively ignored.
 
-// Constant Propagation
-static const bool doConstProp = 0; // Set to 1 to turn on vi15 const propagation
+// Constant Propagation (optimization tier only, see doConstProp(mVU) in microVU.h)
 // Enables Constant Propagation for Jumps based on vi15 'link-register'
 // allowing us to know many indirect jump target addresses.
-// Makes GoW a lot slower due to extra recompilation time and extra code-gen!
+// Makes GoW a lot slower due to extra recompilation time and extra code-gen,
+// so it's only done for programs recompiled by the optimization tier.
 
 // Indirect Jump Caching
 static const bool doJumpCaching = 1; // Set to 1 to enable jump caching
@@ -356,6 +358,18 @@ static const bool doDBitHandling = 0;
 // need this method of pausing the VU should be using the T-Bit instead, however
 // this could prove useful for VU debugging.
 
+//------------------------------------------------------------------
+// Optimization Tier
+//------------------------------------------------------------------
+
+// Hot Program Recompilation
+#define CHECK_VU_OPTTIER (EmuConfig.Speedhacks.vuOptTier)
+static const u32 mVUoptTierThreshold = 1000; // Executions before a program is recompiled
+// When enabled (per game, via the GameDB's mvuOptTier key), programs that have
+// been executed mVUoptTierThreshold times are recompiled as a new microProgram
+// with doConstProp and doFullFlagOpt turned on. Doing this only for hot programs
+// keeps the extra recompilation time and code-gen to the programs that pay it back.
+
 //------------------------------------------------------------------
 // Speed Hacks (can cause infinite loops, SPS, Black Screens, etc...)
 //------------------------------------------------------------------
@@ -20,6 +20,7 @@
 #include "PrecompiledHeader.h"
 #include "newVif_UnpackSSE.h"
 #include "MTVU.h"
+#include "SamplProf.h"
 
 void dVifReserve(int idx) {
 	if(!nVif[idx].recReserve)
@@ -332,6 +333,12 @@ _vifT __fi void dVifUnpack(const u8* data, bool isFill) {
 	VifUnpackSSE_Dynarec(v, v.block).CompileRoutine();
 	nVif[idx].recWritePtr = xGetPtr();
 
+	if (EmuConfig.Profiler.Enabled) {
+		ProfilerRegisterBlock((void*)v.block.startPtr, xGetPtr() - (u8*)v.block.startPtr,
+			"VIF%d:unpack [upk=%02x num=%d mode=%d cl=%d wl=%d mask=%08x]", idx,
+			v.block.upkType, v.block.num, v.block.mode, v.block.cl, v.block.wl, v.block.mask);
+	}
+
 	dVifRecLimit(idx);
 
 	// Run the block we just compiled.  Various conditions may force us to still use
@@ -368,6 +368,195 @@ static IPin* GetFirstPin(IBaseFilter* pBF, PIN_DIRECTION dir)
 	return(NULL);
 }
 
+#else
+
+//
+// GSCaptureWorker
+//
+
+// Frames are copied into a fixed pool of buffers on the GS thread, converted to I420 and written as a
+// yuv4mpeg stream on the worker thread. When the pool runs dry the frame is dropped, the GS thread never
+// waits for the disk or the encoder. A file name starting with '|' is run as a command and fed through a pipe.
+
+class GSCaptureWorker : public GSJobQueue<struct GSCaptureFrame*>
+{
+	FILE* m_fp;
+	bool m_pipe;
+	GSVector2i m_size;
+	uint8* m_yuv;
+	vector<GSCaptureFrame*> m_frames;
+	vector<GSCaptureFrame*> m_free;
+	GSCritSec m_lock;
+	int m_dropped;
+
+public:
+	GSCaptureWorker(FILE* fp, bool pipe, const GSVector2i& size, float fps, int buffers);
+	virtual ~GSCaptureWorker();
+
+	bool Deliver(const void* bits, int pitch, bool rgba);
+
+	void Process(GSCaptureFrame*& frame);
+
+	static void ConvertI420(const uint8* RESTRICT src, uint8* RESTRICT dst, int w, int h, bool rgba);
+};
+
+struct GSCaptureFrame
+{
+	uint8* bits;
+	bool rgba;
+};
+
+GSCaptureWorker::GSCaptureWorker(FILE* fp, bool pipe, const GSVector2i& size, float fps, int buffers)
+	: m_fp(fp)
+	, m_pipe(pipe)
+	, m_size(size)
+	, m_dropped(0)
+{
+	m_yuv = (uint8*)_aligned_malloc(m_size.x * m_size.y * 3 / 2, 32);
+
+	for(int i = 0; i < buffers; i++)
+	{
+		GSCaptureFrame* frame = new GSCaptureFrame();
+
+		frame->bits = (uint8*)_aligned_malloc(m_size.x * m_size.y * 4, 32);
+		frame->rgba = true;
+
+		m_frames.push_back(frame);
+		m_free.push_back(frame);
+	}
+
+	fprintf(m_fp, "YUV4MPEG2 W%d H%d F%d:1000 Ip A1:1 C420jpeg\n", m_size.x, m_size.y, (int)(fps * 1000 + 0.5f));
+}
+
+GSCaptureWorker::~GSCaptureWorker()
+{
+	Wait();
+
+	if(m_pipe) pclose(m_fp);
+	else fclose(m_fp);
+
+	if(m_dropped > 0)
+	{
+		printf("GSdx: capture dropped %d frames\n", m_dropped);
+	}
+
+	for(size_t i = 0; i < m_frames.size(); i++)
+	{
+		_aligned_free(m_frames[i]->bits);
+
+		delete m_frames[i];
+	}
+
+	_aligned_free(m_yuv);
+}
+
+bool GSCaptureWorker::Deliver(const void* bits, int pitch, bool rgba)
+{
+	GSCaptureFrame* frame = NULL;
+
+	m_lock.Lock();
+
+	if(!m_free.empty())
+	{
+		frame = m_free.back();
+
+		m_free.pop_back();
+	}
+
+	m_lock.Unlock();
+
+	if(frame == NULL)
+	{
+		m_dropped++;
+
+		return false;
+	}
+
+	const uint8* src = (const uint8*)bits;
+	uint8* dst = frame->bits;
+
+	for(int j = 0; j < m_size.y; j++, src += pitch, dst += m_size.x * 4)
+	{
+		memcpy(dst, src, m_size.x * 4);
+	}
+
+	frame->rgba = rgba;
+
+	Push(frame);
+
+	return true;
+}
+
+void GSCaptureWorker::Process(GSCaptureFrame*& frame)
+{
+	ConvertI420(frame->bits, m_yuv, m_size.x, m_size.y, frame->rgba);
+
+	m_lock.Lock();
+
+	m_free.push_back(frame);
+
+	m_lock.Unlock();
+
+	fputs("FRAME\n", m_fp);
+	fwrite(m_yuv, m_size.x * m_size.y * 3 / 2, 1, m_fp);
+}
+
+void GSCaptureWorker::ConvertI420(const uint8* RESTRICT src, uint8* RESTRICT dst, int w, int h, bool rgba)
+{
+	// 2x2 pixels per iteration, w and h are multiples of 8
+
+	GSVector4 ys(0.257f, 0.504f, 0.098f, 0.0f);
+	GSVector4 us(-0.148f / 4, -0.291f / 4, 0.439f / 4, 0.0f);
+	GSVector4 vs(0.439f / 4, -0.368f / 4, -0.071f / 4, 0.0f);
+
+	if(!rgba)
+	{
+		ys = ys.zyxw();
+		us = us.zyxw();
+		vs = vs.zyxw();
+	}
+
+	const GSVector4 yoffset(16.0f);
+	const GSVector4 uvoffset(128.0f);
+
+	uint8* RESTRICT y = dst;
+	uint8* RESTRICT u = y + w * h;
+	uint8* RESTRICT v = u + (w >> 1) * (h >> 1);
+
+	for(int j = 0; j < h; j += 2, src += w * 8, y += w * 2, u += w >> 1, v += w >> 1)
+	{
+		const uint32* s0 = (const uint32*)src;
+		const uint32* s1 = (const uint32*)(src + w * 4);
+
+		uint16* RESTRICT y0 = (uint16*)y;
+		uint16* RESTRICT y1 = (uint16*)(y + w);
+
+		for(int i = 0; i < w; i += 2)
+		{
+			GSVector4 c00 = GSVector4::rgba32(s0[i + 0]);
+			GSVector4 c01 = GSVector4::rgba32(s0[i + 1]);
+			GSVector4 c10 = GSVector4::rgba32(s1[i + 0]);
+			GSVector4 c11 = GSVector4::rgba32(s1[i + 1]);
+
+			GSVector4 c = (c00 + c01) + (c10 + c11);
+
+			GSVector4 l = (c00 * ys).hadd(c01 * ys).hadd((c10 * ys).hadd(c11 * ys)) + yoffset; // y00 y01 y10 y11
+			GSVector4 uv = (c * us).hadd(c * vs);
+
+			uv = uv.hadd(uv) + uvoffset; // u v u v
+
+			uint32 yyyy = GSVector4i(l).rgba32();
+			uint32 uvuv = GSVector4i(uv).rgba32();
+
+			y0[i >> 1] = (uint16)(yyyy & 0xffff);
+			y1[i >> 1] = (uint16)(yyyy >> 16);
+
+			u[i >> 1] = (uint8)(uvuv & 0xff);
+			v[i >> 1] = (uint8)((uvuv >> 8) & 0xff);
+		}
+	}
+}
+
 #endif
 
 //
@@ -377,6 +566,11 @@ static IPin* GetFirstPin(IBaseFilter* pBF, PIN_DIRECTION dir)
 GSCapture::GSCapture()
 	: m_capturing(false)
 {
+#ifndef _WINDOWS
+
+	m_worker = NULL;
+
+#endif
 }
 
 GSCapture::~GSCapture()
@@ -472,6 +666,31 @@ bool GSCapture::BeginCapture(float fps)
 
 	CComQIPtr<IGSSource>(m_src)->DeliverNewSegment();
 
+#else
+
+	m_size.x = (theApp.GetConfig("CaptureWidth", 640) + 7) & ~7;
+	m_size.y = (theApp.GetConfig("CaptureHeight", 480) + 7) & ~7;
+
+	string fn = theApp.GetConfig("CaptureFileName", "");
+
+	if(fn.empty())
+	{
+		fn = "gsdx_capture.y4m";
+	}
+
+	bool pipe = fn[0] == '|';
+
+	FILE* fp = pipe ? popen(fn.c_str() + 1, "w") : fopen(fn.c_str(), "wb");
+
+	if(fp == NULL)
+	{
+		fprintf(stderr, "GSdx: cannot open capture output %s\n", fn.c_str());
+
+		return false;
+	}
+
+	m_worker = new GSCaptureWorker(fp, pipe, m_size, fps, std::max<int>(theApp.GetConfig("CaptureBuffers", 8), 2));
+
 #endif
 
 	m_capturing = true;
@@ -499,6 +718,13 @@ bool GSCapture::DeliverFrame(const void* bits, int pitch, bool rgba)
 		return true;
 	}
 
+#else
+
+	if(m_worker)
+	{
+		return m_worker->Deliver(bits, pitch, rgba);
+	}
+
 #endif
 
 	return false;
@@ -524,6 +750,15 @@ bool GSCapture::EndCapture()
 		m_graph = NULL;
 	}
 
+#else
+
+	if(m_worker)
+	{
+		delete m_worker; // waits for the queued frames
+
+		m_worker = NULL;
+	}
+
 #endif
 
 	m_capturing = false;
@@ -38,6 +38,10 @@ class GSCapture : protected GSCritSec
 	CComPtr<IGraphBuilder> m_graph;
 	CComPtr<IBaseFilter> m_src;
 
+	#else
+
+	class GSCaptureWorker* m_worker;
+
 	#endif
 
 public:
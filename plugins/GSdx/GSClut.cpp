@@ -36,6 +36,24 @@ GSClut::GSClut(GSLocalMemory* mem)
 	m_write.dirty = true;
 	m_read.dirty = true;
 
+	m_priv32 = m_buff32;
+	m_priv64 = m_buff64;
+
+	m_cache = (CacheEntry*)_aligned_malloc(sizeof(CacheEntry) * CACHE_SIZE, 32);
+	m_cache_entry = NULL;
+	m_cache_age = 0;
+
+	for(int i = 0; i < CACHE_SIZE; i++)
+	{
+		m_cache[i].key = 0xffffffff; // never matches
+		m_cache[i].age = 0;
+	}
+
+	memset(m_slot, 0, sizeof(m_slot));
+
+	m_write_id_count = 0;
+	m_write_id_next = 1;
+
 	for(int i = 0; i < 16; i++)
 	{
 		for(int j = 0; j < 64; j++)
@@ -90,12 +108,15 @@ GSClut::GSClut(GSLocalMemory* mem)
 
 GSClut::~GSClut()
 {
+	_aligned_free(m_cache);
+
 	vmfree(m_clut, CLUT_ALLOC_SIZE);
 }
 
 void GSClut::Invalidate()
 {
 	m_write.dirty = true;
+	m_write_id_count = 0;
 }
 
 bool GSClut::WriteTest(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT)
@@ -123,7 +144,16 @@ void GSClut::Write(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT)
 	m_write.dirty = false;
 	m_read.dirty = true;
 
-	(this->*m_wc[TEX0.CSM][TEX0.CPSM][TEX0.PSM])(TEX0, TEXCLUT);
+	writeCLUT wc = m_wc[TEX0.CSM][TEX0.CPSM][TEX0.PSM];
+
+	(this->*wc)(TEX0, TEXCLUT);
+
+	if(wc == &GSClut::WriteCLUT_NULL)
+	{
+		return;
+	}
+
+	uint32 id = GetWriteId(TEX0, TEXCLUT);
 
 	// Mirror write to other half of buffer to simulate wrapping memory
 
@@ -135,20 +165,78 @@ void GSClut::Write(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT)
 
 		memcpy(m_clut + 512 + offset, m_clut + offset, sizeof(*m_clut) * min(size, 512 - offset));
 		memcpy(m_clut, m_clut + 512, sizeof(*m_clut) * max(0, size + offset - 512));
+
+		for(int i = 0; i < size >> 4; i++)
+		{
+			m_slot[((offset >> 4) + i) & 31] = id;
+		}
 	}
 	else
 	{
 		int size = 16;
 
 		memcpy(m_clut + 512 + offset, m_clut + offset, sizeof(*m_clut) * size);
+
+		m_slot[offset >> 4] = id;
 		
 		if(TEX0.CPSM < PSM_PSMCT16)
 		{
 			memcpy(m_clut + 512 + 256 + offset, m_clut + 256 + offset, sizeof(*m_clut) * size);
+
+			m_slot[(offset >> 4) + 16] = id;
 		}
 	}
 }
 
+uint32 GSClut::GetWriteId(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT)
+{
+	// only the fields the load depends on, TBP0, CLD and the others would just hide a repeated load
+
+	uint32 state[2];
+
+	state[0] = TEX0.CBP | (TEX0.CPSM << 14) | (TEX0.CSM << 18) | (TEX0.CSA << 19) | ((TEX0.PSM == PSM_PSMT8 || TEX0.PSM == PSM_PSMT8H) ? 1 << 24 : 0);
+	state[1] = TEX0.CSM ? (TEXCLUT.CBW | (TEXCLUT.COU << 6) | (TEXCLUT.COV << 12)) : 0;
+
+	for(int i = 0; i < m_write_id_count; i++)
+	{
+		WriteId* w = &m_write_id[i];
+
+		if(w->state[0] == state[0] && w->state[1] == state[1])
+		{
+			return w->id;
+		}
+	}
+
+	if(m_write_id_next == 0xffffffff)
+	{
+		// out of ids, forget everything that refers to the old ones, what is in m_clut now becomes id 0
+
+		for(int i = 0; i < CACHE_SIZE; i++)
+		{
+			m_cache[i].key = 0xffffffff;
+			m_cache[i].age = 0;
+		}
+
+		memset(m_slot, 0, sizeof(m_slot));
+
+		m_write_id_count = 0;
+		m_write_id_next = 1;
+	}
+
+	if(m_write_id_count == WRITE_ID_COUNT)
+	{
+		m_write_id_count = 0;
+	}
+
+	WriteId* w = &m_write_id[m_write_id_count++];
+
+	w->state[0] = state[0];
+	w->state[1] = state[1];
+	w->id = m_write_id_next++;
+
+	return w->id;
+}
+
 void GSClut::WriteCLUT32_I8_CSM1(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT)
 {
 	ALIGN_STACK(32);
@@ -238,6 +326,12 @@ void GSClut::Read(const GIFRegTEX0& TEX0)
 		m_read.TEX0 = TEX0;
 		m_read.dirty = false;
 
+		// cache entries are only filled by Read32
+
+		m_buff32 = m_priv32;
+		m_buff64 = m_priv64;
+		m_cache_entry = NULL;
+
 		uint16* clut = m_clut;
 
 		if(TEX0.CPSM == PSM_PSMCT32 || TEX0.CPSM == PSM_PSMCT24)
@@ -288,6 +382,15 @@ void GSClut::Read32(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA)
 
 		uint16* clut = m_clut;
 
+		// the alpha range depends on CPSM and TEXA too, they are part of the key even where the expansion does not use them,
+		// the content itself is identified by the ids of the slots read, it is never hashed or compared
+
+		uint32 key = TEX0.CPSM | (TEX0.PSM << 6) | (TEXA.AEM << 12) | (TEXA.TA0 << 16) | (TEXA.TA1 << 24);
+
+		CacheEntry* e = NULL;
+
+		bool hit = false;
+
 		if(TEX0.CPSM == PSM_PSMCT32 || TEX0.CPSM == PSM_PSMCT24)
 		{
 			switch(TEX0.PSM)
@@ -295,15 +398,23 @@ void GSClut::Read32(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA)
 			case PSM_PSMT8:
 			case PSM_PSMT8H:
 				clut += (TEX0.CSA & 15) << 4; // disney golf title screen
-				ReadCLUT_T32_I8(clut, m_buff32);
+				e = LookupCache(key, TEX0.CSA & 15, 32, 1, hit);
+				if(!hit) 
+				{
+					ReadCLUT_T32_I8(clut, e->buff32);
+				}
 				break;
 			case PSM_PSMT4:
 			case PSM_PSMT4HL:
 			case PSM_PSMT4HH:
 				clut += (TEX0.CSA & 15) << 4;
-				// TODO: merge these functions
-				ReadCLUT_T32_I4(clut, m_buff32);
-				ExpandCLUT64_T32_I8(m_buff32, (uint64*)m_buff64); // sw renderer does not need m_buff64 anymore
+				e = LookupCache(key, TEX0.CSA & 15, 2, 16, hit);
+				if(!hit)
+				{
+					// TODO: merge these functions
+					ReadCLUT_T32_I4(clut, e->buff32);
+					ExpandCLUT64_T32_I8(e->buff32, (uint64*)e->buff64); // sw renderer does not need m_buff64 anymore
+				}
 				break;
 			}
 		}
@@ -314,19 +425,89 @@ void GSClut::Read32(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA)
 			case PSM_PSMT8:
 			case PSM_PSMT8H:
 				clut += TEX0.CSA << 4;
-				Expand16(clut, m_buff32, 256, TEXA);
+				e = LookupCache(key, TEX0.CSA, 16, 1, hit);
+				if(!hit)
+				{
+					Expand16(clut, e->buff32, 256, TEXA);
+				}
 				break;
 			case PSM_PSMT4:
 			case PSM_PSMT4HL:
 			case PSM_PSMT4HH:
 				clut += TEX0.CSA << 4;
-				// TODO: merge these functions
-				Expand16(clut, m_buff32, 16, TEXA);
-				ExpandCLUT64_T32_I8(m_buff32, (uint64*)m_buff64); // sw renderer does not need m_buff64 anymore
+				e = LookupCache(key, TEX0.CSA, 1, 1, hit);
+				if(!hit)
+				{
+					// TODO: merge these functions
+					Expand16(clut, e->buff32, 16, TEXA);
+					ExpandCLUT64_T32_I8(e->buff32, (uint64*)e->buff64); // sw renderer does not need m_buff64 anymore
+				}
 				break;
 			}
 		}
+
+		if(e != NULL)
+		{
+			m_buff32 = e->buff32;
+			m_buff64 = e->buff64;
+			m_cache_entry = e;
+
+			if(hit && !e->adirty)
+			{
+				m_read.amin = e->amin;
+				m_read.amax = e->amax;
+				m_read.adirty = false;
+			}
+		}
+	}
+}
+
+GSClut::CacheEntry* GSClut::LookupCache(uint32 key, int slot, int n, int step, bool& hit)
+{
+	// n slots of m_slot from slot, step apart, wrapping around like m_clut does
+
+	uint32 src[32];
+
+	for(int i = 0; i < n; i++)
+	{
+		src[i] = m_slot[(slot + i * step) & 31];
+	}
+
+	CacheEntry* oldest = &m_cache[0];
+
+	m_cache_age++;
+
+	for(int i = 0; i < CACHE_SIZE; i++)
+	{
+		CacheEntry* e = &m_cache[i];
+
+		if(e->key == key && e->slot == slot && memcmp(e->src, src, sizeof(*src) * n) == 0)
+		{
+			e->age = m_cache_age;
+
+			hit = true;
+
+			return e;
+		}
+
+		if(e->age < oldest->age)
+		{
+			oldest = e;
+		}
 	}
+
+	CacheEntry* e = oldest;
+
+	memcpy(e->src, src, sizeof(*src) * n);
+
+	e->slot = slot;
+	e->key = key;
+	e->age = m_cache_age;
+	e->adirty = true;
+
+	hit = false;
+
+	return e;
 }
 
 void GSClut::GetAlphaMinMax32(int& amin, int& amax)
@@ -390,6 +571,13 @@ void GSClut::GetAlphaMinMax32(int& amin, int& amax)
 			m_read.amin = v0.min_i16(v1).extract16<0>();
 			m_read.amax = v0.max_i16(v1).extract16<1>();
 		}
+
+		if(m_cache_entry != NULL)
+		{
+			m_cache_entry->amin = m_read.amin;
+			m_cache_entry->amax = m_read.amax;
+			m_cache_entry->adirty = false;
+		}
 	}
 
 	amin = m_read.amin;
@@ -56,6 +56,51 @@ __aligned(class, 32) GSClut : public GSAlignedClass<32>
 		bool IsDirty(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA);
 	} m_read;
 
+	// each 16 entry slot of m_clut remembers the id of the load that wrote it, a repeated load (same CBP, CPSM,
+	// CSM, CSA, I4/I8 and TEXCLUT for CSM2) gets its old id back until Invalidate, the memory it reads from may
+	// have changed after that, so equal ids mean equal content without looking at it
+
+	struct WriteId
+	{
+		uint32 state[2];
+		uint32 id;
+	};
+
+	enum {WRITE_ID_COUNT = 16};
+
+	WriteId m_write_id[WRITE_ID_COUNT];
+	int m_write_id_count;
+	uint32 m_write_id_next;
+	uint32 m_slot[32];
+
+	uint32 GetWriteId(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT);
+
+	// expanded palettes of Read32 keyed by the ids of the slots they came from, games switching
+	// between a few palettes find them here and m_buff32/m_buff64 are simply pointed at the entry
+
+	__aligned(struct, 32) CacheEntry
+	{
+		uint32 buff32[256];
+		uint64 buff64[256];
+		uint32 src[32]; // m_slot ids of the part of m_clut this palette was read from
+		uint32 slot; // the first of them
+		uint32 key; // CPSM, PSM and TEXA
+		uint32 age;
+		int amin, amax;
+		bool adirty;
+	};
+
+	enum {CACHE_SIZE = 8};
+
+	CacheEntry* m_cache;
+	CacheEntry* m_cache_entry; // the one m_buff32/m_buff64 point to, NULL if they are the private buffers
+	uint32 m_cache_age;
+
+	uint32* m_priv32;
+	uint64* m_priv64;
+
+	CacheEntry* LookupCache(uint32 key, int slot, int n, int step, bool& hit);
+
 	typedef void (GSClut::*writeCLUT)(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT);
 
 	writeCLUT m_wc[2][16][64];
@@ -23,6 +23,7 @@
 
 #include "GS.h"
 #include "GSCodeBuffer.h"
+#include "GSUtil.h"
 #include "xbyak/xbyak.h"
 #include "xbyak/xbyak_util.h"
 
@@ -190,6 +191,8 @@ public:
 
 			m_cgmap[key] = ret;
 
+			GSUtil::PerfMapRegister(cg->getCode(), cg->getSize(), format("%s<%016llx>()", m_name.c_str(), (uint64)key).c_str());
+
 			#ifdef ENABLE_VTUNE
 
 			// vtune method registration
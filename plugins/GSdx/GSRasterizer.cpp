@@ -30,6 +30,26 @@
 
 #define THREAD_HEIGHT 4
 
+// the depth bounds of a block (8 lines) are only ever touched by the thread owning its scanlines
+
+#if THREAD_HEIGHT < 3
+#error "THREAD_HEIGHT must not be smaller than the height of a block"
+#endif
+
+static __forceinline uint32 ZFloor(float z)
+{
+	z -= z * (1.0f / 4096) + 2; // interpolation error margin
+
+	return z > 0 ? (uint32)z : 0;
+}
+
+static __forceinline uint32 ZCeil(float z)
+{
+	z += z * (1.0f / 4096) + 2;
+
+	return z < 4294967040.0f ? (uint32)z : 0xffffffff;
+}
+
 int GSRasterizerData::s_counter = 0;
 
 GSRasterizer::GSRasterizer(IDrawScanline* ds, int id, int threads, GSPerfMon* perfmon)
@@ -144,6 +164,24 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 	m_fscissor_x = GSVector4(data->scissor).xzxz();
 	m_fscissor_y = GSVector4(data->scissor).ywyw();
 
+	m_zb = data->zbounds;
+	m_zprim.reject = false;
+	m_zprim.cover = false;
+
+	if(m_zb.bounds != NULL)
+	{
+		if(m_zb.lower)
+		{
+			LowerZBounds(data->bbox.rintersect(data->scissor), ZFloor(m_zb.zmin));
+		}
+
+		if(data->primclass == GS_TRIANGLE_CLASS || data->primclass == GS_SPRITE_CLASS)
+		{
+			m_zprim.reject = m_zb.reject;
+			m_zprim.cover = m_zb.cover;
+		}
+	}
+
 	switch(data->primclass)
 	{
 	case GS_POINT_CLASS:
@@ -496,6 +534,11 @@ void GSRasterizer::DrawTriangle(const GSVertexSW* vertex, const uint32* index)
 		}
 	}
 
+	if(m_zprim.reject || m_zprim.cover)
+	{
+		SetupZBounds(v0.p.min(v1.p).min(v2.p), v0.p.max(v1.p).max(v2.p));
+	}
+
 	Flush(vertex, index, dscan);
 
 	if(m_ds->HasEdge())
@@ -591,6 +634,11 @@ void GSRasterizer::DrawSprite(const GSVertexSW* vertex, const uint32* index)
 
 	if(r.rempty()) return;
 
+	if(m_zprim.reject || m_zprim.cover)
+	{
+		SetupZBounds(v[0].p.min(v[1].p), v[0].p.max(v[1].p));
+	}
+
 	GSVertexSW scan = v[0];
 
 	if(m_ds->IsSolidRect())
@@ -600,6 +648,8 @@ void GSRasterizer::DrawSprite(const GSVertexSW* vertex, const uint32* index)
 			m_ds->DrawRect(r, scan);
 
 			m_pixels += r.width() * r.height();
+
+			if(m_zprim.cover) RaiseZBounds(r);
 		}
 		else
 		{
@@ -615,6 +665,8 @@ void GSRasterizer::DrawSprite(const GSVertexSW* vertex, const uint32* index)
 			
 				m_pixels += r.width() * r.height();
 
+				if(m_zprim.cover) RaiseZBounds(r);
+
 				top = r.bottom + ((m_threads - 1) << THREAD_HEIGHT);
 			}
 		}
@@ -622,6 +674,8 @@ void GSRasterizer::DrawSprite(const GSVertexSW* vertex, const uint32* index)
 		return;
 	}
 
+	GSVector4i zr = r;
+
 	GSVertexSW dv = v[1] - v[0];
 
 	GSVector4 dt = dv.t / dv.p.xyxy();
@@ -645,15 +699,20 @@ void GSRasterizer::DrawSprite(const GSVertexSW* vertex, const uint32* index)
 	{
 		if(IsOneOfMyScanlines(r.top))
 		{
-			m_pixels += r.width();
+			if(!m_zprim.reject || !IsZRejected(r.width(), r.left, r.top))
+			{
+				m_pixels += r.width();
 
-			m_ds->DrawScanline(r.width(), r.left, r.top, scan);
+				m_ds->DrawScanline(r.width(), r.left, r.top, scan);
+			}
 		}
 
 		if(++r.top >= r.bottom) break;
 
 		scan.t += dedge.t;
 	}
+
+	if(m_zprim.cover) RaiseZBounds(zr);
 }
 
 void GSRasterizer::DrawEdge(const GSVertexSW& v0, const GSVertexSW& v1, const GSVertexSW& dv, int orientation, int side)
@@ -877,11 +936,18 @@ void GSRasterizer::Flush(const GSVertexSW* vertex, const uint32* index, const GS
 				int left = e->p.i16[1];
 				int top = e->p.i16[2];
 
-				m_pixels += pixels;
+				if(!m_zprim.reject || !IsZRejected(pixels, left, top))
+				{
+					m_pixels += pixels;
+
+					m_ds->DrawScanline(pixels, left, top, *e);
+				}
 
-				m_ds->DrawScanline(pixels, left, top, *e++);
+				e++;
 			}
 			while(e < ee);
+
+			if(m_zprim.cover) RaiseZBounds(m_edge.buff, ee);
 		}
 		else
 		{
@@ -902,6 +968,136 @@ void GSRasterizer::Flush(const GSVertexSW* vertex, const uint32* index, const GS
 	}
 }
 
+// depth bounds
+//
+// Each block of the depth buffer has a lower bound of the values stored in it. A span which is
+// below the bounds of all of its blocks cannot pass GEQUAL or GREATER and is not drawn. The bounds
+// are lowered for blocks which a batch might write smaller values into, and raised when a primitive
+// writes every pixel of a block. The renderer resets them when the memory is written by other means.
+
+void GSRasterizer::SetupZBounds(const GSVector4& zmin, const GSVector4& zmax)
+{
+	uint32 z = ZCeil(zmax.z);
+
+	m_zprim.limit = m_zb.ztst == ZTST_GREATER ? z - 1 : z; // z = 0 wraps around and never rejects
+	m_zprim.raise = m_zb.ztst == ZTST_ALWAYS ? ZFloor(m_zb.zmin) : ZFloor(zmin.z);
+}
+
+bool GSRasterizer::IsZRejected(int pixels, int left, int top) const
+{
+	const uint32* RESTRICT bounds = m_zb.bounds;
+
+	int base = m_zb.row[top >> 3];
+
+	for(int x = left >> 3, right = (left + pixels + 7) >> 3; x < right; x++)
+	{
+		uint32 b = base + m_zb.col[x];
+
+		if(b >= MAX_BLOCKS || bounds[b] <= m_zprim.limit)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void GSRasterizer::LowerZBounds(const GSVector4i& r, uint32 zmin)
+{
+	uint32* RESTRICT bounds = m_zb.bounds;
+
+	GSVector4i rb = (r + GSVector4i(0, 0, 1, 1)).rintersect(GSVector4i(0, 0, 2048, 2048)); // edges may reach one pixel outside
+
+	for(int y = rb.top & ~7; y < rb.bottom; y += 8)
+	{
+		if(!IsOneOfMyScanlines(y)) continue;
+
+		int base = m_zb.row[y >> 3];
+
+		for(int x = rb.left & ~7; x < rb.right; x += 8)
+		{
+			uint32 b = base + m_zb.col[x >> 3];
+
+			if(b < MAX_BLOCKS)
+			{
+				if(bounds[b] > zmin) bounds[b] = zmin;
+			}
+			else
+			{
+				bounds[b & (MAX_BLOCKS - 1)] = 0; // wrapped around
+			}
+		}
+	}
+}
+
+void GSRasterizer::RaiseZBounds(int left, int right, int top)
+{
+	uint32* RESTRICT bounds = m_zb.bounds;
+
+	int mask = m_zb.bw - 1;
+
+	left = (left + mask) & ~mask;
+	right = right & ~mask;
+
+	int base = m_zb.row[top >> 3];
+
+	for(int x = left; x < right; x += 8)
+	{
+		uint32 b = base + m_zb.col[x >> 3];
+
+		if(b < MAX_BLOCKS && bounds[b] < m_zprim.raise)
+		{
+			bounds[b] = m_zprim.raise;
+		}
+	}
+}
+
+void GSRasterizer::RaiseZBounds(const GSVector4i& r)
+{
+	for(int y = (r.top + 7) & ~7, bottom = r.bottom & ~7; y < bottom; y += 8)
+	{
+		if(IsOneOfMyScanlines(y))
+		{
+			RaiseZBounds(r.left, r.right, y);
+		}
+	}
+}
+
+void GSRasterizer::RaiseZBounds(const GSVertexSW* RESTRICT e, const GSVertexSW* RESTRICT ee)
+{
+	// spans are sorted by top, a block row is covered where all of its 8 lines overlap
+
+	while(e < ee)
+	{
+		int top = e->p.i16[2];
+
+		if(top & 7)
+		{
+			e++;
+
+			continue;
+		}
+
+		int left = e->p.i16[1];
+		int right = left + e->p.i16[0];
+
+		int i = 1;
+
+		for(; i < 8 && e + i < ee && e[i].p.i16[2] == top + i; i++)
+		{
+			left = std::max<int>(left, e[i].p.i16[1]);
+			right = std::min<int>(right, e[i].p.i16[1] + e[i].p.i16[0]);
+		}
+
+		if(i == 8 && left < right)
+		{
+			RaiseZBounds(left, right, top);
+		}
+
+		e += i;
+	}
+}
+
 //
 
 GSRasterizerList::GSRasterizerList(int threads, GSPerfMon* perfmon)
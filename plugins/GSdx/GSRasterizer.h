@@ -46,6 +46,19 @@ public:
 	int pixels;
 	int counter;
 
+	struct ZBounds
+	{
+		uint32* bounds; // lower bound of the depth values stored in each block, NULL if not used by this batch
+		const short* row; // depth buffer block offsets
+		const short* col;
+		int bw; // block width
+		int ztst;
+		float zmin; // smallest depth value written by the batch
+		bool reject; // skip spans which fail the depth test in all of their blocks
+		bool lower; // blocks touched by the batch may go below their bounds, lower them to zmin
+		bool cover; // every pixel of a fully covered block writes its depth
+	} zbounds;
+
 	GSRasterizerData() 
 		: scissor(GSVector4i::zero())
 		, bbox(GSVector4i::zero())
@@ -60,6 +73,8 @@ public:
 		, pixels(0)
 	{
 		counter = s_counter++;
+
+		memset(&zbounds, 0, sizeof(zbounds));
 	}
 
 	virtual ~GSRasterizerData() 
@@ -132,6 +147,8 @@ protected:
 	GSVector4 m_fscissor_y;
 	struct {GSVertexSW* buff; int count;} m_edge;
 	int m_pixels;
+	GSRasterizerData::ZBounds m_zb;
+	struct {uint32 limit, raise; bool reject, cover;} m_zprim;
 
 	typedef void (GSRasterizer::*DrawPrimPtr)(const GSVertexSW* v, int count);
 
@@ -148,6 +165,13 @@ protected:
 	__forceinline void AddScanline(GSVertexSW* e, int pixels, int left, int top, const GSVertexSW& scan);
 	__forceinline void Flush(const GSVertexSW* vertex, const uint32* index, const GSVertexSW& dscan, bool edge = false);
 
+	__forceinline void SetupZBounds(const GSVector4& zmin, const GSVector4& zmax);
+	__forceinline bool IsZRejected(int pixels, int left, int top) const;
+	void LowerZBounds(const GSVector4i& r, uint32 zmin);
+	void RaiseZBounds(int left, int right, int top);
+	void RaiseZBounds(const GSVector4i& r);
+	void RaiseZBounds(const GSVertexSW* RESTRICT e, const GSVertexSW* RESTRICT ee);
+
 public:
 	GSRasterizer(IDrawScanline* ds, int id, int threads, GSPerfMon* perfmon);
 	virtual ~GSRasterizer();
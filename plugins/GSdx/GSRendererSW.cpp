@@ -44,6 +44,17 @@ GSRendererSW::GSRendererSW(int threads)
 	memset(m_fzb_pages, 0, sizeof(m_fzb_pages));
 	memset(m_tex_pages, 0, sizeof(m_tex_pages));
 
+	m_zbounds = NULL;
+
+	if(theApp.GetConfig("zreject", 1))
+	{
+		m_zbounds = (uint32*)_aligned_malloc(MAX_BLOCKS * sizeof(uint32), 32);
+
+		memset(m_zbounds, 0, MAX_BLOCKS * sizeof(uint32));
+	}
+
+	memset(m_zbounds_fmt, 0, sizeof(m_zbounds_fmt));
+
 	#define InitCVB(P) \
 		m_cvb[P][0][0] = &GSRendererSW::ConvertVertexBuffer<P, 0, 0>; \
 		m_cvb[P][0][1] = &GSRendererSW::ConvertVertexBuffer<P, 0, 1>; \
@@ -68,6 +79,8 @@ GSRendererSW::~GSRendererSW()
 	delete m_rl;
 
 	_aligned_free(m_output);
+
+	if(m_zbounds != NULL) _aligned_free(m_zbounds);
 }
 
 void GSRendererSW::Reset()
@@ -76,9 +89,28 @@ void GSRendererSW::Reset()
 
 	m_tc->RemoveAll();
 
+	if(m_zbounds != NULL)
+	{
+		memset(m_zbounds, 0, MAX_BLOCKS * sizeof(uint32));
+		memset(m_zbounds_fmt, 0, sizeof(m_zbounds_fmt));
+	}
+
 	GSRenderer::Reset();
 }
 
+int GSRendererSW::Defrost(const GSFreezeData* fd)
+{
+	Sync(-1);
+
+	if(m_zbounds != NULL)
+	{
+		memset(m_zbounds, 0, MAX_BLOCKS * sizeof(uint32));
+		memset(m_zbounds_fmt, 0, sizeof(m_zbounds_fmt));
+	}
+
+	return GSRenderer::Defrost(fd);
+}
+
 void GSRendererSW::VSync(int field)
 {
 	Sync(0); // IncAge might delete a cached texture in use
@@ -424,6 +456,27 @@ void GSRendererSW::Draw()
 
 	sd->UsePages(fb_pages, m_context->offset.fb->psm, zb_pages, m_context->offset.zb->psm);
 
+	// depth bounds, the rasterizer skips spans hidden in all of their blocks
+
+	if(m_zbounds != NULL && gd.sel.zb)
+	{
+		GSRasterizerData::ZBounds& zb = sd->zbounds;
+
+		float zmax = gd.sel.zpsm == 0 ? 4294967295.0f : gd.sel.zpsm == 1 ? 16777215.0f : 65535.0f;
+
+		bool overflow = gd.sel.zoverflow || m_vt.m_max.p.z > zmax; // written values may wrap around
+
+		zb.bounds = m_zbounds;
+		zb.row = context->offset.zb->block.row;
+		zb.col = context->offset.zb->block.col;
+		zb.bw = GSLocalMemory::m_psm[context->ZBUF.PSM].bs.x;
+		zb.ztst = gd.sel.ztst;
+		zb.zmin = overflow ? 0 : m_vt.m_min.p.z;
+		zb.reject = gd.sel.ztest && !gd.sel.zoverflow;
+		zb.lower = gd.sel.zwrite && (overflow || gd.sel.ztst == ZTST_ALWAYS);
+		zb.cover = gd.sel.zwrite && !overflow && !gd.sel.ftest;
+	}
+
 	//
 
 	if(s_dump)
@@ -528,6 +581,11 @@ void GSRendererSW::Queue(shared_ptr<GSRasterizerData>& item)
 		fflush(s_fp);
 	}
 
+	if(m_zbounds != NULL)
+	{
+		UpdateZBounds(sd);
+	}
+
 	m_rl->Queue(item);
 
 	// invalidate new parts rendered onto
@@ -607,6 +665,17 @@ void GSRendererSW::InvalidateVideoMem(const GIFRegBITBLTBUF& BITBLTBUF, const GS
 	}
 
 	m_tc->InvalidatePages(m_tmp_pages, o->psm); // if texture update runs on a thread and Sync(5) happens then this must come later
+
+	if(m_zbounds != NULL)
+	{
+		for(uint32* RESTRICT p = m_tmp_pages; *p != GSOffset::EOP; p++)
+		{
+			if(m_zbounds_fmt[*p] != 0)
+			{
+				ResetZBounds(*p);
+			}
+		}
+	}
 }
 
 void GSRendererSW::InvalidateLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r, bool clut)
@@ -862,6 +931,88 @@ bool GSRendererSW::CheckSourcePages(SharedData* sd)
 	return false;
 }
 
+void GSRendererSW::ResetZBounds(uint32 page)
+{
+	memset(&m_zbounds[page << 5], 0, 32 * sizeof(uint32));
+
+	m_zbounds_fmt[page] = 0;
+}
+
+void GSRendererSW::UpdateZBounds(SharedData* sd)
+{
+	// the bounds only follow the depth writes of the rasterizer, anything else drawn over them resets the pages
+
+	GSRasterizerData::ZBounds& zb = sd->zbounds;
+
+	const uint32* fb_pages = sd->global.sel.fwrite ? sd->m_fb_pages : NULL;
+	const uint32* zb_pages = zb.bounds != NULL ? sd->m_zb_pages : NULL;
+
+	if(fb_pages != NULL && zb_pages != NULL)
+	{
+		uint32 used[512 / 32];
+
+		memset(used, 0, sizeof(used));
+
+		for(const uint32* p = zb_pages; *p != GSOffset::EOP; p++)
+		{
+			used[*p >> 5] |= 1 << (*p & 31);
+		}
+
+		for(const uint32* p = fb_pages; *p != GSOffset::EOP; p++)
+		{
+			if(used[*p >> 5] & (1 << (*p & 31)))
+			{
+				// the frame and the depth buffer overlap, give up on this one
+
+				if(!m_rl->IsSynced()) Sync(8);
+
+				for(const uint32* q = zb_pages; *q != GSOffset::EOP; q++)
+				{
+					ResetZBounds(*q);
+				}
+
+				zb.bounds = NULL;
+				zb_pages = NULL;
+
+				break;
+			}
+		}
+	}
+
+	if(fb_pages != NULL)
+	{
+		for(const uint32* p = fb_pages; *p != GSOffset::EOP; p++)
+		{
+			if(m_zbounds_fmt[*p] != 0)
+			{
+				ResetZBounds(*p); // CheckTargetPages already synced if it was a depth buffer in use
+			}
+		}
+	}
+
+	if(zb_pages != NULL)
+	{
+		// the full PSM, PSMZ16 and PSMZ16S store the same values with different block layouts
+
+		uint8 fmt = (uint8)m_context->ZBUF.PSM;
+
+		for(const uint32* p = zb_pages; *p != GSOffset::EOP; p++)
+		{
+			if(m_zbounds_fmt[*p] != fmt)
+			{
+				if(m_zbounds_fmt[*p] != 0)
+				{
+					if(!m_rl->IsSynced()) Sync(8); // bounds of another format, may still be updated by the queue
+
+					ResetZBounds(*p);
+				}
+
+				m_zbounds_fmt[*p] = fmt;
+			}
+		}
+	}
+}
+
 #include "GSTextureSW.h"
 
 bool GSRendererSW::GetScanlineGlobalData(SharedData* data)
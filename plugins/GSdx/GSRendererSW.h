@@ -74,6 +74,8 @@ protected:
 	uint32 m_fzb_pages[512]; // uint16 frame/zbuf pages interleaved
 	uint16 m_tex_pages[512];
 	uint32 m_tmp_pages[512 + 1];
+	uint32* m_zbounds; // lower bound of the depth values in each block, NULL if disabled
+	uint8 m_zbounds_fmt[512]; // ZBUF.PSM of the bounds kept for a page (never 0), 0 if they are all zero
 
 	void Reset();
 	void VSync(int field);
@@ -92,9 +94,14 @@ protected:
 	bool CheckTargetPages(const uint32* fb_pages, const uint32* zb_pages, const GSVector4i& r);
 	bool CheckSourcePages(SharedData* sd);
 
+	void ResetZBounds(uint32 page);
+	void UpdateZBounds(SharedData* sd);
+
 	bool GetScanlineGlobalData(SharedData* data);
 
 public:
 	GSRendererSW(int threads);
 	virtual ~GSRendererSW();
+
+	int Defrost(const GSFreezeData* fd);
 };
@@ -47,6 +47,9 @@ GSState::GSState()
 {
 	m_nativeres = !!theApp.GetConfig("nativeres", 1);
 
+	m_coalesce.enabled = !!theApp.GetConfig("coalesce", 1);
+	m_coalesce.pending = false;
+
 	s_n = 0;
 	s_dump = !!theApp.GetConfig("dump", 0);
 	s_save = !!theApp.GetConfig("save", 0);
@@ -231,6 +234,10 @@ void GSState::Reset()
 	m_vertex.next = 0;
 	m_index.tail = 0;
 
+	m_vt.ResetKick();
+
+	m_coalesce.pending = false;
+
 	m_texflush = true;
 }
 
@@ -746,10 +753,14 @@ template<int i> void GSState::ApplyTEX0(GIFRegTEX0& TEX0)
 
 	uint64 mask = 0x1f78001c3fffffffull; // TBP0 TBW PSM TW TCC TFX CPSM CSA
 
-	if(wt || PRIM->CTXT == i && ((TEX0.u64 ^ m_env.CTXT[i].TEX0.u64) & mask))
+	if(wt)
 	{
 		Flush();
 	}
+	else if(PRIM->CTXT == i && ((TEX0.u64 ^ m_env.CTXT[i].TEX0.u64) & mask))
+	{
+		DeferFlush();
+	}
 
 	TEX0.CPSM &= 0xa; // 1010b
 
@@ -896,7 +907,7 @@ template<int i> void GSState::GIFRegHandlerCLAMP(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->CLAMP != m_env.CTXT[i].CLAMP)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	m_env.CTXT[i].CLAMP = (GSVector4i)r->CLAMP;
@@ -915,7 +926,7 @@ template<int i> void GSState::GIFRegHandlerTEX1(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->TEX1 != m_env.CTXT[i].TEX1)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	m_env.CTXT[i].TEX1 = (GSVector4i)r->TEX1;
@@ -946,7 +957,7 @@ template<int i> void GSState::GIFRegHandlerXYOFFSET(const GIFReg* RESTRICT r)
 
 	if(!o.eq(m_env.CTXT[i].XYOFFSET))
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	m_env.CTXT[i].XYOFFSET = o;
@@ -1004,7 +1015,7 @@ void GSState::GIFRegHandlerSCANMSK(const GIFReg* RESTRICT r)
 {
 	if(r->SCANMSK != m_env.SCANMSK)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	m_env.SCANMSK = (GSVector4i)r->SCANMSK;
@@ -1014,7 +1025,7 @@ template<int i> void GSState::GIFRegHandlerMIPTBP1(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->MIPTBP1 != m_env.CTXT[i].MIPTBP1)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	m_env.CTXT[i].MIPTBP1 = (GSVector4i)r->MIPTBP1;
@@ -1024,7 +1035,7 @@ template<int i> void GSState::GIFRegHandlerMIPTBP2(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->MIPTBP2 != m_env.CTXT[i].MIPTBP2)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	m_env.CTXT[i].MIPTBP2 = (GSVector4i)r->MIPTBP2;
@@ -1034,7 +1045,7 @@ void GSState::GIFRegHandlerTEXA(const GIFReg* RESTRICT r)
 {
 	if(r->TEXA != m_env.TEXA)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	m_env.TEXA = (GSVector4i)r->TEXA;
@@ -1044,7 +1055,7 @@ void GSState::GIFRegHandlerFOGCOL(const GIFReg* RESTRICT r)
 {
 	if(r->FOGCOL != m_env.FOGCOL)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	m_env.FOGCOL = (GSVector4i)r->FOGCOL;
@@ -1059,7 +1070,7 @@ template<int i> void GSState::GIFRegHandlerSCISSOR(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->SCISSOR != m_env.CTXT[i].SCISSOR)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	m_env.CTXT[i].SCISSOR = (GSVector4i)r->SCISSOR;
@@ -1078,7 +1089,7 @@ template<int i> void GSState::GIFRegHandlerALPHA(const GIFReg* RESTRICT r)
 
 	if(PRIM->CTXT == i && r->ALPHA != m_env.CTXT[i].ALPHA)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	m_env.CTXT[i].ALPHA = (GSVector4i)r->ALPHA;
@@ -1094,7 +1105,7 @@ void GSState::GIFRegHandlerDIMX(const GIFReg* RESTRICT r)
 
 	if(r->DIMX != m_env.DIMX)
 	{
-		Flush();
+		DeferFlush();
 
 		update = true;
 	}
@@ -1111,7 +1122,7 @@ void GSState::GIFRegHandlerDTHE(const GIFReg* RESTRICT r)
 {
 	if(r->DTHE != m_env.DTHE)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	m_env.DTHE = (GSVector4i)r->DTHE;
@@ -1121,7 +1132,7 @@ void GSState::GIFRegHandlerCOLCLAMP(const GIFReg* RESTRICT r)
 {
 	if(r->COLCLAMP != m_env.COLCLAMP)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	m_env.COLCLAMP = (GSVector4i)r->COLCLAMP;
@@ -1134,7 +1145,7 @@ template<int i> void GSState::GIFRegHandlerTEST(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->TEST != m_env.CTXT[i].TEST)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	m_env.CTXT[i].TEST = (GSVector4i)r->TEST;
@@ -1147,7 +1158,7 @@ void GSState::GIFRegHandlerPABE(const GIFReg* RESTRICT r)
 {
 	if(r->PABE != m_env.PABE)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	m_env.PABE = (GSVector4i)r->PABE;
@@ -1157,7 +1168,7 @@ template<int i> void GSState::GIFRegHandlerFBA(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->FBA != m_env.CTXT[i].FBA)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	m_env.CTXT[i].FBA = (GSVector4i)r->FBA;
@@ -1167,7 +1178,7 @@ template<int i> void GSState::GIFRegHandlerFRAME(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->FRAME != m_env.CTXT[i].FRAME)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	if((m_env.CTXT[i].FRAME.u32[0] ^ r->FRAME.u32[0]) & 0x3f3f01ff) // FBP FBW PSM
@@ -1209,7 +1220,7 @@ template<int i> void GSState::GIFRegHandlerZBUF(const GIFReg* RESTRICT r)
 
 	if(PRIM->CTXT == i && ZBUF != m_env.CTXT[i].ZBUF)
 	{
-		Flush();
+		DeferFlush();
 	}
 
 	if((m_env.CTXT[i].ZBUF.u32[0] ^ ZBUF.u32[0]) & 0x3f0001ff) // ZBP PSM
@@ -1372,6 +1383,13 @@ void GSState::FlushWrite()
 
 void GSState::FlushPrim()
 {
+	if(m_coalesce.pending)
+	{
+		FlushDeferred();
+
+		return;
+	}
+
 	if(m_index.tail > 0)
 	{
 		GSVertex buff[2];
@@ -1413,7 +1431,7 @@ void GSState::FlushPrim()
 		{
 			// FIXME: berserk fpsm = 27 (8H)
 
-			m_vt.Update(m_vertex.buff, m_index.buff, m_index.tail, GSUtil::GetPrimClass(PRIM->PRIM));
+			m_vt.Update(GSUtil::GetPrimClass(PRIM->PRIM)); // min/max were collected by VertexKick
 
 			Draw();
 
@@ -1423,6 +1441,8 @@ void GSState::FlushPrim()
 
 		m_index.tail = 0;
 
+		m_vt.ResetKick();
+
 		m_vertex.head = 0;
 
 		if(unused > 0)
@@ -1440,6 +1460,116 @@ void GSState::FlushPrim()
 	}
 }
 
+void GSState::DeferFlush()
+{
+	FlushWrite();
+
+	if(!m_coalesce.enabled || m_index.tail == 0)
+	{
+		FlushPrim();
+
+		return;
+	}
+
+	if(!m_coalesce.pending)
+	{
+		m_coalesce.env = m_env;
+		m_coalesce.pending = true;
+	}
+}
+
+void GSState::FlushDeferred()
+{
+	ALIGN_STACK(32);
+
+	// the queued primitives are drawn with the environment they were kicked with
+
+	GSDrawingEnvironment env = m_env;
+
+	m_coalesce.pending = false;
+
+	m_env = m_coalesce.env;
+
+	UpdateContext();
+
+	FlushPrim();
+
+	m_env = env;
+
+	UpdateContext();
+}
+
+void GSState::CoalesceOrFlush()
+{
+	if(IsSameDrawingContext(m_coalesce.env))
+	{
+		m_coalesce.pending = false; // nothing observable changed, keep adding to the same batch
+	}
+	else
+	{
+		FlushDeferred();
+	}
+}
+
+bool GSState::IsSameDrawingContext(const GSDrawingEnvironment& env) const
+{
+	// PRIM is not compared, changing it always flushes
+
+	const GSDrawingContext& a = env.CTXT[PRIM->CTXT];
+	const GSDrawingContext& b = m_env.CTXT[PRIM->CTXT];
+
+	if(a.XYOFFSET.u64 != b.XYOFFSET.u64
+	|| a.SCISSOR.u64 != b.SCISSOR.u64
+	|| a.TEST.u64 != b.TEST.u64
+	|| a.FBA.u64 != b.FBA.u64
+	|| a.FRAME.u64 != b.FRAME.u64
+	|| a.ZBUF.u64 != b.ZBUF.u64
+	|| env.SCANMSK.u64 != m_env.SCANMSK.u64
+	|| env.COLCLAMP.u64 != m_env.COLCLAMP.u64
+	|| env.DTHE.u64 != m_env.DTHE.u64)
+	{
+		return false;
+	}
+
+	if(m_env.DTHE.DTHE && env.DIMX.u64 != m_env.DIMX.u64)
+	{
+		return false;
+	}
+
+	if(PRIM->TME)
+	{
+		uint64 mask = 0x1f78001c3fffffffull; // TBP0 TBW PSM TW TCC TFX CPSM CSA, see ApplyTEX0
+
+		if(((a.TEX0.u64 ^ b.TEX0.u64) & mask)
+		|| a.TEX1.u64 != b.TEX1.u64
+		|| a.CLAMP.u64 != b.CLAMP.u64
+		|| a.MIPTBP1.u64 != b.MIPTBP1.u64
+		|| a.MIPTBP2.u64 != b.MIPTBP2.u64
+		|| env.TEXA.u64 != m_env.TEXA.u64)
+		{
+			return false;
+		}
+	}
+
+	if(PRIM->ABE || PRIM->AA1)
+	{
+		if(a.ALPHA.u64 != b.ALPHA.u64 || env.PABE.u64 != m_env.PABE.u64)
+		{
+			return false;
+		}
+	}
+
+	if(PRIM->FGE)
+	{
+		if(env.FOGCOL.u64 != m_env.FOGCOL.u64)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 //
 
 void GSState::Write(const uint8* mem, int len)
@@ -2264,6 +2394,8 @@ void GSState::UpdateScissor()
 
 void GSState::UpdateVertexKick() 
 {
+	m_vt.UpdateKick();
+
 	if(m_frameskip) return;
 
 	uint32 prim = PRIM->PRIM;
@@ -2311,6 +2443,11 @@ void GSState::GrowVertexBuffer()
 template<uint32 prim> 
 __forceinline void GSState::VertexKick(uint32 skip)
 {
+	if(m_coalesce.pending)
+	{
+		CoalesceOrFlush(); // the first vertex after a deferred flush decides if it has to be drawn
+	}
+
 	ASSERT(m_vertex.tail < m_vertex.maxcount);
 
 	size_t head = m_vertex.head;
@@ -2515,10 +2652,12 @@ __forceinline void GSState::VertexKick(uint32 skip)
 		break;
 	case GS_INVALID:
 		m_vertex.tail = head;
-		break;
+		return;
 	default:
 		__assume(0);
 	}
+
+	m_vt.Kick(m_vertex.buff, buff); // the vertices are still in the cache, no need for a second pass in FlushPrim
 }
 
 void GSState::GetTextureMinMax(GSVector4i& r, const GIFRegTEX0& TEX0, const GIFRegCLAMP& CLAMP, bool linear)
@@ -166,6 +166,21 @@ protected:
 		size_t tail;
 	} m_index;
 
+	// draw coalescing: a register write that ends the current batch only saves the environment of the queued
+	// primitives, if the next vertex arrives with an equivalent drawing context the batch simply continues
+
+	struct
+	{
+		GSDrawingEnvironment env;
+		bool pending;
+		bool enabled;
+	} m_coalesce;
+
+	void DeferFlush();
+	void FlushDeferred();
+	void CoalesceOrFlush();
+	bool IsSameDrawingContext(const GSDrawingEnvironment& env) const;
+
 	void UpdateContext();
 	void UpdateScissor();
 
@@ -238,7 +253,7 @@ public:
 	void ReadFIFO(uint8* mem, int size);
 	template<int index> void Transfer(const uint8* mem, uint32 size);
 	int Freeze(GSFreezeData* fd, bool sizeonly);
-	int Defrost(const GSFreezeData* fd);
+	virtual int Defrost(const GSFreezeData* fd);
 	void GetLastTag(uint32* tag) {*tag = m_path3hack; m_path3hack = 0;}
 	virtual void SetGameCRC(uint32 crc, int options);
 	void SetFrameSkip(int skip);
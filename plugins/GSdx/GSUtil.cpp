@@ -22,6 +22,7 @@
 #include "stdafx.h"
 #include "GS.h"
 #include "GSUtil.h"
+#include "GSdx.h"
 #include "xbyak/xbyak_util.h"
 
 #ifdef _WINDOWS
@@ -29,6 +30,8 @@
 #else
 #define SVN_REV 0
 #define SVN_MODS 0
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 const char* GSUtil::GetLibName()
@@ -215,6 +218,39 @@ bool GSUtil::CheckSSE()
 	return true;
 }
 
+// Names generated code for perf, which reads /tmp/perf-<pid>.map ("<start> <size> <name>"
+// per line, in hex).  PCSX2 appends its recompiler blocks to the same file, so each line
+// is written with a single write() on an O_APPEND descriptor.  Enabled with perfmap=1.
+
+void GSUtil::PerfMapRegister(const void* code, size_t size, const char* name)
+{
+	#ifndef _WINDOWS
+
+	static int fd = -2;
+
+	if(fd == -2)
+	{
+		fd = -1;
+
+		if(theApp.GetConfig("perfmap", 0))
+		{
+			fd = open(format("/tmp/perf-%d.map", (int)getpid()).c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+		}
+	}
+
+	if(fd >= 0 && size > 0)
+	{
+		string line = format("%lx %lx %s\n", (unsigned long)code, (unsigned long)size, name);
+
+		if(write(fd, line.c_str(), line.size()) != (ssize_t)line.size())
+		{
+			fprintf(stderr, "GSdx: write to the perf map failed\n");
+		}
+	}
+
+	#endif
+}
+
 #ifdef _WINDOWS
 
 bool GSUtil::CheckDirectX()
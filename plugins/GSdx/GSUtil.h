@@ -39,6 +39,8 @@ public:
 
 	static bool CheckSSE();
 
+	static void PerfMapRegister(const void* code, size_t size, const char* name);
+
 #ifdef _WINDOWS
 
 	static bool CheckDirectX();
@@ -48,6 +48,25 @@ GSVertexTrace::GSVertexTrace(const GSState* state)
 	InitUpdate(GS_LINE_CLASS);
 	InitUpdate(GS_TRIANGLE_CLASS);
 	InitUpdate(GS_SPRITE_CLASS);
+
+	#define InitKick2(P, IIP, TME) \
+		m_fk[0][TME][IIP][P] = &GSVertexTrace::KickPrim<P, IIP, TME, 0>; \
+		m_fk[1][TME][IIP][P] = &GSVertexTrace::KickPrim<P, IIP, TME, 1>; \
+
+	#define InitKick(P) \
+		InitKick2(P, 0, 0) \
+		InitKick2(P, 0, 1) \
+		InitKick2(P, 1, 0) \
+		InitKick2(P, 1, 1) \
+
+	InitKick(GS_POINT_CLASS);
+	InitKick(GS_LINE_CLASS);
+	InitKick(GS_TRIANGLE_CLASS);
+	InitKick(GS_SPRITE_CLASS);
+
+	m_kick = m_fk[0][0][0][GS_POINT_CLASS];
+
+	ResetMinMax(m_kmm);
 }
 
 void GSVertexTrace::Update(const void* vertex, const uint32* index, int count, GS_PRIM_CLASS primclass)
@@ -61,6 +80,35 @@ void GSVertexTrace::Update(const void* vertex, const uint32* index, int count, G
 
 	(this->*m_fmm[color][fst][tme][iip][primclass])(vertex, index, count);
 
+	UpdateFilter();
+}
+
+void GSVertexTrace::Update(GS_PRIM_CLASS primclass)
+{
+	m_primclass = primclass;
+
+	uint32 tme = m_state->PRIM->TME;
+	uint32 fst = m_state->PRIM->FST;
+	uint32 color = !(m_state->PRIM->TME && m_state->m_context->TEX0.TFX == TFX_DECAL && m_state->m_context->TEX0.TCC);
+
+	// Kick always accumulates colors, whether they are needed depends on TEX0 at draw time
+
+	UpdateMinMax(m_kmm, tme, fst, color);
+
+	UpdateFilter();
+}
+
+void GSVertexTrace::UpdateKick()
+{
+	GS_PRIM_CLASS primclass = GSUtil::GetPrimClass(m_state->PRIM->PRIM);
+
+	if(primclass == GS_INVALID_CLASS) primclass = GS_POINT_CLASS; // nothing gets indexed
+
+	m_kick = m_fk[m_state->PRIM->FST][m_state->PRIM->TME][m_state->PRIM->IIP][primclass];
+}
+
+void GSVertexTrace::UpdateFilter()
+{
 	m_eq.value = (m_min.c == m_max.c).mask() | ((m_min.p == m_max.p).mask() << 16) | ((m_min.t == m_max.t).mask() << 20);
 
 	m_alpha.valid = false;
@@ -110,334 +158,430 @@ void GSVertexTrace::Update(const void* vertex, const uint32* index, int count, G
 	}
 }
 
-template<GS_PRIM_CLASS primclass, uint32 iip, uint32 tme, uint32 fst, uint32 color>
-void GSVertexTrace::FindMinMax(const void* vertex, const uint32* index, int count)
+void GSVertexTrace::ResetMinMax(MinMax& mm)
 {
-	const GSDrawingContext* context = m_state->m_context;
+	mm.tmin = s_minmax.xxxx();
+	mm.tmax = s_minmax.yyyy();
 
-	int n = 1;
+	#if _M_SSE >= 0x501
 
-	switch(primclass)
-	{
-	case GS_POINT_CLASS:
-		n = 1;
-		break;
-	case GS_LINE_CLASS:
-	case GS_SPRITE_CLASS:
-		n = 2;
-		break;
-	case GS_TRIANGLE_CLASS:
-		n = 3;
-		break;
-	}
-
-	GSVector4 tmin = s_minmax.xxxx();
-	GSVector4 tmax = s_minmax.yyyy();
-	GSVector4i cmin = GSVector4i::xffffffff();
-	GSVector4i cmax = GSVector4i::zero();
+	mm.cmin = GSVector8i::xffffffff();
+	mm.cmax = GSVector8i::zero();
+	mm.pmin = GSVector8i::xffffffff();
+	mm.pmax = GSVector8i::zero();
 
-	#if _M_SSE >= 0x401
+	#elif _M_SSE >= 0x401
 
-	GSVector4i pmin = GSVector4i::xffffffff();
-	GSVector4i pmax = GSVector4i::zero();
+	mm.cmin = GSVector4i::xffffffff();
+	mm.cmax = GSVector4i::zero();
+	mm.pmin = GSVector4i::xffffffff();
+	mm.pmax = GSVector4i::zero();
 
 	#else
 
-	GSVector4 pmin = s_minmax.xxxx();
-	GSVector4 pmax = s_minmax.yyyy();
-	
-	#endif
+	mm.cmin = GSVector4i::xffffffff();
+	mm.cmax = GSVector4i::zero();
+	mm.pmin = s_minmax.xxxx();
+	mm.pmax = s_minmax.yyyy();
 
-	const GSVertex* RESTRICT v = (GSVertex*)vertex;
+	#endif
+}
 
-	for(int i = 0; i < count; i += n)
+template<GS_PRIM_CLASS primclass, uint32 iip, uint32 tme, uint32 fst, uint32 color>
+__forceinline void GSVertexTrace::AddPrim(MinMax& mm, const GSVertex* RESTRICT v, const uint32* RESTRICT index)
+{
+	if(primclass == GS_POINT_CLASS)
 	{
-		if(primclass == GS_POINT_CLASS)
+		GSVector4i c(v[index[0]].m[0]);
+
+		if(color)
 		{
-			GSVector4i c(v[index[i]].m[0]);
+			#if _M_SSE >= 0x501
 
-			if(color)
-			{
-				cmin = cmin.min_u8(c);
-				cmax = cmax.max_u8(c);
-			}
+			mm.cmin = mm.cmin.min_u8(GSVector8i(c.m));
+			mm.cmax = mm.cmax.max_u8(GSVector8i(c.m));
 
-			if(tme)
+			#else
+
+			mm.cmin = mm.cmin.min_u8(c);
+			mm.cmax = mm.cmax.max_u8(c);
+
+			#endif
+		}
+
+		if(tme)
+		{
+			if(!fst)
 			{
-				if(!fst)
-				{
-					GSVector4 stq = GSVector4::cast(c);
+				GSVector4 stq = GSVector4::cast(c);
 
-					GSVector4 q = stq.wwww();
+				GSVector4 q = stq.wwww();
 
-					stq = (stq.xyww() * q.rcpnr()).xyww(q);
+				stq = (stq.xyww() * q.rcpnr()).xyww(q);
 
-					tmin = tmin.min(stq);
-					tmax = tmax.max(stq);
-				}
-				else
-				{
-					GSVector4i uv(v[index[i]].m[1]);
+				mm.tmin = mm.tmin.min(stq);
+				mm.tmax = mm.tmax.max(stq);
+			}
+			else
+			{
+				GSVector4i uv(v[index[0]].m[1]);
 
-					GSVector4 st = GSVector4(uv.uph16()).xyxy();
+				GSVector4 st = GSVector4(uv.uph16()).xyxy();
 
-					tmin = tmin.min(st);
-					tmax = tmax.max(st);
-				}
+				mm.tmin = mm.tmin.min(st);
+				mm.tmax = mm.tmax.max(st);
 			}
+		}
 
-			GSVector4i xyzf(v[index[i]].m[1]);
+		GSVector4i xyzf(v[index[0]].m[1]);
 
-			GSVector4i xy = xyzf.upl16();
-			GSVector4i z = xyzf.yyyy();
+		GSVector4i xy = xyzf.upl16();
+		GSVector4i z = xyzf.yyyy();
 
-			#if _M_SSE >= 0x401
+		#if _M_SSE >= 0x501
 
-			GSVector4i p = xy.blend16<0xf0>(z.uph32(xyzf));
+		GSVector4i p = xy.blend16<0xf0>(z.uph32(xyzf));
 
-			pmin = pmin.min_u32(p);
-			pmax = pmax.max_u32(p);
+		mm.pmin = mm.pmin.min_u32(GSVector8i(p.m));
+		mm.pmax = mm.pmax.max_u32(GSVector8i(p.m));
 
-			#else
+		#elif _M_SSE >= 0x401
 
-			GSVector4 p = GSVector4(xy.upl64(z.srl32(1).upl32(xyzf.wwww())));
+		GSVector4i p = xy.blend16<0xf0>(z.uph32(xyzf));
 
-			pmin = pmin.min(p);
-			pmax = pmax.max(p);
+		mm.pmin = mm.pmin.min_u32(p);
+		mm.pmax = mm.pmax.max_u32(p);
 
-			#endif
-		}
-		else if(primclass == GS_LINE_CLASS)
+		#else
+
+		GSVector4 p = GSVector4(xy.upl64(z.srl32(1).upl32(xyzf.wwww())));
+
+		mm.pmin = mm.pmin.min(p);
+		mm.pmax = mm.pmax.max(p);
+
+		#endif
+	}
+	else if(primclass == GS_LINE_CLASS || primclass == GS_SPRITE_CLASS)
+	{
+		GSVector4i c0(v[index[0]].m[0]);
+		GSVector4i c1(v[index[1]].m[0]);
+
+		#if _M_SSE >= 0x501
+
+		// both vertices in one register, the upper lane holds the second one
+
+		GSVector8i c01 = GSVector8i::load(&v[index[0]].m[0], &v[index[1]].m[0]);
+		GSVector8i xyzf01 = GSVector8i::load(&v[index[0]].m[1], &v[index[1]].m[1]);
+
+		#endif
+
+		if(color)
 		{
-			GSVector4i c0(v[index[i + 0]].m[0]);
-			GSVector4i c1(v[index[i + 1]].m[0]);
+			#if _M_SSE >= 0x501
 
-			if(color)
+			if(iip)
 			{
-				if(iip)
-				{
-					cmin = cmin.min_u8(c0.min_u8(c1));
-					cmax = cmax.max_u8(c0.max_u8(c1));
-				}
-				else
-				{
-					cmin = cmin.min_u8(c1);
-					cmax = cmax.max_u8(c1);
-				}
+				mm.cmin = mm.cmin.min_u8(c01);
+				mm.cmax = mm.cmax.max_u8(c01);
+			}
+			else
+			{
+				mm.cmin = mm.cmin.min_u8(GSVector8i(c1.m));
+				mm.cmax = mm.cmax.max_u8(GSVector8i(c1.m));
+			}
+
+			#else
+
+			if(iip)
+			{
+				mm.cmin = mm.cmin.min_u8(c0.min_u8(c1));
+				mm.cmax = mm.cmax.max_u8(c0.max_u8(c1));
+			}
+			else
+			{
+				mm.cmin = mm.cmin.min_u8(c1);
+				mm.cmax = mm.cmax.max_u8(c1);
 			}
 
-			if(tme)
+			#endif
+		}
+
+		if(tme)
+		{
+			if(!fst)
 			{
-				if(!fst)
+				GSVector4 stq0 = GSVector4::cast(c0);
+				GSVector4 stq1 = GSVector4::cast(c1);
+
+				if(primclass == GS_SPRITE_CLASS)
 				{
-					GSVector4 stq0 = GSVector4::cast(c0);
-					GSVector4 stq1 = GSVector4::cast(c1);
+					GSVector4 q = stq1.wwww().rcpnr();
 
+					stq0 = (stq0.xyww() * q).xyww(stq1);
+					stq1 = (stq1.xyww() * q).xyww(stq1);
+				}
+				else
+				{
 					GSVector4 q = stq0.wwww(stq1).rcpnr();
 
 					stq0 = (stq0.xyww() * q.xxxx()).xyww(stq0);
 					stq1 = (stq1.xyww() * q.zzzz()).xyww(stq1);
-
-					tmin = tmin.min(stq0.min(stq1));
-					tmax = tmax.max(stq0.max(stq1));
 				}
-				else
-				{
-					GSVector4i uv0(v[index[i + 0]].m[1]);
-					GSVector4i uv1(v[index[i + 1]].m[1]);
 
-					GSVector4 st0 = GSVector4(uv0.uph16()).xyxy();
-					GSVector4 st1 = GSVector4(uv1.uph16()).xyxy();
+				mm.tmin = mm.tmin.min(stq0.min(stq1));
+				mm.tmax = mm.tmax.max(stq0.max(stq1));
+			}
+			else
+			{
+				GSVector4i uv0(v[index[0]].m[1]);
+				GSVector4i uv1(v[index[1]].m[1]);
 
-					tmin = tmin.min(st0.min(st1));
-					tmax = tmax.max(st0.max(st1));
-				}
+				GSVector4 st0 = GSVector4(uv0.uph16()).xyxy();
+				GSVector4 st1 = GSVector4(uv1.uph16()).xyxy();
+
+				mm.tmin = mm.tmin.min(st0.min(st1));
+				mm.tmax = mm.tmax.max(st0.max(st1));
 			}
+		}
 
-			GSVector4i xyzf0(v[index[i + 0]].m[1]);
-			GSVector4i xyzf1(v[index[i + 1]].m[1]);
+		GSVector4i xyzf0(v[index[0]].m[1]);
+		GSVector4i xyzf1(v[index[1]].m[1]);
 
-			GSVector4i xy0 = xyzf0.upl16();
-			GSVector4i z0 = xyzf0.yyyy();
-			GSVector4i xy1 = xyzf1.upl16();
-			GSVector4i z1 = xyzf1.yyyy();
+		// sprites take F from the second vertex
 
-			#if _M_SSE >= 0x401
+		GSVector4i f0 = primclass == GS_SPRITE_CLASS ? xyzf1 : xyzf0;
 
-			GSVector4i p0 = xy0.blend16<0xf0>(z0.uph32(xyzf0));
-			GSVector4i p1 = xy1.blend16<0xf0>(z1.uph32(xyzf1));
+		#if _M_SSE >= 0x501
 
-			pmin = pmin.min_u32(p0.min_u32(p1));
-			pmax = pmax.max_u32(p0.max_u32(p1));
+		GSVector8i f01 = primclass == GS_SPRITE_CLASS ? GSVector8i(xyzf1.m) : xyzf01;
 
-			#else
+		GSVector8i p01 = xyzf01.upl16().blend16<0xf0>(xyzf01.yyyy().uph32(f01));
 
-			GSVector4 p0 = GSVector4(xy0.upl64(z0.srl32(1).upl32(xyzf0.wwww())));
-			GSVector4 p1 = GSVector4(xy1.upl64(z1.srl32(1).upl32(xyzf1.wwww())));
+		mm.pmin = mm.pmin.min_u32(p01);
+		mm.pmax = mm.pmax.max_u32(p01);
 
-			pmin = pmin.min(p0.min(p1));
-			pmax = pmax.max(p0.max(p1));
+		#else
 
-			#endif
-		}
-		else if(primclass == GS_TRIANGLE_CLASS)
-		{
-			GSVector4i c0(v[index[i + 0]].m[0]);
-			GSVector4i c1(v[index[i + 1]].m[0]);
-			GSVector4i c2(v[index[i + 2]].m[0]);
+		GSVector4i xy0 = xyzf0.upl16();
+		GSVector4i z0 = xyzf0.yyyy();
+		GSVector4i xy1 = xyzf1.upl16();
+		GSVector4i z1 = xyzf1.yyyy();
 
-			if(color)
-			{
-				if(iip)
-				{
-					cmin = cmin.min_u8(c2).min_u8(c0.min_u8(c1));
-					cmax = cmax.max_u8(c2).max_u8(c0.max_u8(c1));
-				}
-				else
-				{
-					cmin = cmin.min_u8(c2);
-					cmax = cmax.max_u8(c2);
-				}
-			}
+		#if _M_SSE >= 0x401
 
-			if(tme)
-			{
-				if(!fst)
-				{
-					GSVector4 stq0 = GSVector4::cast(c0);
-					GSVector4 stq1 = GSVector4::cast(c1);
-					GSVector4 stq2 = GSVector4::cast(c2);
+		GSVector4i p0 = xy0.blend16<0xf0>(z0.uph32(f0));
+		GSVector4i p1 = xy1.blend16<0xf0>(z1.uph32(xyzf1));
 
-					GSVector4 q = stq0.wwww(stq1).xzww(stq2).rcpnr();
+		mm.pmin = mm.pmin.min_u32(p0.min_u32(p1));
+		mm.pmax = mm.pmax.max_u32(p0.max_u32(p1));
 
-					stq0 = (stq0.xyww() * q.xxxx()).xyww(stq0);
-					stq1 = (stq1.xyww() * q.yyyy()).xyww(stq1);
-					stq2 = (stq2.xyww() * q.zzzz()).xyww(stq2);
+		#else
 
-					tmin = tmin.min(stq2).min(stq0.min(stq1));
-					tmax = tmax.max(stq2).max(stq0.max(stq1));
-				}
-				else
-				{
-					GSVector4i uv0(v[index[i + 0]].m[1]);
-					GSVector4i uv1(v[index[i + 1]].m[1]);
-					GSVector4i uv2(v[index[i + 2]].m[1]);
+		GSVector4 p0 = GSVector4(xy0.upl64(z0.srl32(1).upl32(f0.wwww())));
+		GSVector4 p1 = GSVector4(xy1.upl64(z1.srl32(1).upl32(xyzf1.wwww())));
 
-					GSVector4 st0 = GSVector4(uv0.uph16()).xyxy();
-					GSVector4 st1 = GSVector4(uv1.uph16()).xyxy();
-					GSVector4 st2 = GSVector4(uv2.uph16()).xyxy();
+		mm.pmin = mm.pmin.min(p0.min(p1));
+		mm.pmax = mm.pmax.max(p0.max(p1));
 
-					tmin = tmin.min(st2).min(st0.min(st1));
-					tmax = tmax.max(st2).max(st0.max(st1));
-				}
-			}
+		#endif
 
-			GSVector4i xyzf0(v[index[i + 0]].m[1]);
-			GSVector4i xyzf1(v[index[i + 1]].m[1]);
-			GSVector4i xyzf2(v[index[i + 2]].m[1]);
+		#endif
+	}
+	else if(primclass == GS_TRIANGLE_CLASS)
+	{
+		GSVector4i c0(v[index[0]].m[0]);
+		GSVector4i c1(v[index[1]].m[0]);
+		GSVector4i c2(v[index[2]].m[0]);
 
-			GSVector4i xy0 = xyzf0.upl16();
-			GSVector4i z0 = xyzf0.yyyy();
-			GSVector4i xy1 = xyzf1.upl16();
-			GSVector4i z1 = xyzf1.yyyy();
-			GSVector4i xy2 = xyzf2.upl16();
-			GSVector4i z2 = xyzf2.yyyy();
+		#if _M_SSE >= 0x501
 
-			#if _M_SSE >= 0x401
+		// first two vertices in one register, the third one is broadcast to both lanes
 
-			GSVector4i p0 = xy0.blend16<0xf0>(z0.uph32(xyzf0));
-			GSVector4i p1 = xy1.blend16<0xf0>(z1.uph32(xyzf1));
-			GSVector4i p2 = xy2.blend16<0xf0>(z2.uph32(xyzf2));
+		GSVector8i c01 = GSVector8i::load(&v[index[0]].m[0], &v[index[1]].m[0]);
+		GSVector8i xyzf01 = GSVector8i::load(&v[index[0]].m[1], &v[index[1]].m[1]);
 
-			pmin = pmin.min_u32(p2).min_u32(p0.min_u32(p1));
-			pmax = pmax.max_u32(p2).max_u32(p0.max_u32(p1));
+		#endif
 
-			#else
+		if(color)
+		{
+			#if _M_SSE >= 0x501
 
-			GSVector4 p0 = GSVector4(xy0.upl64(z0.srl32(1).upl32(xyzf0.wwww())));
-			GSVector4 p1 = GSVector4(xy1.upl64(z1.srl32(1).upl32(xyzf1.wwww())));
-			GSVector4 p2 = GSVector4(xy2.upl64(z2.srl32(1).upl32(xyzf2.wwww())));
+			if(iip)
+			{
+				mm.cmin = mm.cmin.min_u8(GSVector8i(c2.m)).min_u8(c01);
+				mm.cmax = mm.cmax.max_u8(GSVector8i(c2.m)).max_u8(c01);
+			}
+			else
+			{
+				mm.cmin = mm.cmin.min_u8(GSVector8i(c2.m));
+				mm.cmax = mm.cmax.max_u8(GSVector8i(c2.m));
+			}
 
-			pmin = pmin.min(p2).min(p0.min(p1));
-			pmax = pmax.max(p2).max(p0.max(p1));
+			#else
+
+			if(iip)
+			{
+				mm.cmin = mm.cmin.min_u8(c2).min_u8(c0.min_u8(c1));
+				mm.cmax = mm.cmax.max_u8(c2).max_u8(c0.max_u8(c1));
+			}
+			else
+			{
+				mm.cmin = mm.cmin.min_u8(c2);
+				mm.cmax = mm.cmax.max_u8(c2);
+			}
 
 			#endif
 		}
-		else if(primclass == GS_SPRITE_CLASS)
+
+		if(tme)
 		{
-			GSVector4i c0(v[index[i + 0]].m[0]);
-			GSVector4i c1(v[index[i + 1]].m[0]);
+			if(!fst)
+			{
+				GSVector4 stq0 = GSVector4::cast(c0);
+				GSVector4 stq1 = GSVector4::cast(c1);
+				GSVector4 stq2 = GSVector4::cast(c2);
 
-			if(color)
+				GSVector4 q = stq0.wwww(stq1).xzww(stq2).rcpnr();
+
+				stq0 = (stq0.xyww() * q.xxxx()).xyww(stq0);
+				stq1 = (stq1.xyww() * q.yyyy()).xyww(stq1);
+				stq2 = (stq2.xyww() * q.zzzz()).xyww(stq2);
+
+				mm.tmin = mm.tmin.min(stq2).min(stq0.min(stq1));
+				mm.tmax = mm.tmax.max(stq2).max(stq0.max(stq1));
+			}
+			else
 			{
-				if(iip)
-				{
-					cmin = cmin.min_u8(c0.min_u8(c1));
-					cmax = cmax.max_u8(c0.max_u8(c1));
-				}
-				else
-				{
-					cmin = cmin.min_u8(c1);
-					cmax = cmax.max_u8(c1);
-				}
+				GSVector4i uv0(v[index[0]].m[1]);
+				GSVector4i uv1(v[index[1]].m[1]);
+				GSVector4i uv2(v[index[2]].m[1]);
+
+				GSVector4 st0 = GSVector4(uv0.uph16()).xyxy();
+				GSVector4 st1 = GSVector4(uv1.uph16()).xyxy();
+				GSVector4 st2 = GSVector4(uv2.uph16()).xyxy();
+
+				mm.tmin = mm.tmin.min(st2).min(st0.min(st1));
+				mm.tmax = mm.tmax.max(st2).max(st0.max(st1));
 			}
+		}
 
-			if(tme)
-			{
-				if(!fst)
-				{
-					GSVector4 stq0 = GSVector4::cast(c0);
-					GSVector4 stq1 = GSVector4::cast(c1);
+		GSVector4i xyzf2(v[index[2]].m[1]);
 
-					GSVector4 q = stq1.wwww().rcpnr();
+		GSVector4i xy2 = xyzf2.upl16();
+		GSVector4i z2 = xyzf2.yyyy();
 
-					stq0 = (stq0.xyww() * q).xyww(stq1);
-					stq1 = (stq1.xyww() * q).xyww(stq1);
+		#if _M_SSE >= 0x501
 
-					tmin = tmin.min(stq0.min(stq1));
-					tmax = tmax.max(stq0.max(stq1));
-				}
-				else
-				{
-					GSVector4i uv0(v[index[i + 0]].m[1]);
-					GSVector4i uv1(v[index[i + 1]].m[1]);
+		GSVector4i p2 = xy2.blend16<0xf0>(z2.uph32(xyzf2));
 
-					GSVector4 st0 = GSVector4(uv0.uph16()).xyxy();
-					GSVector4 st1 = GSVector4(uv1.uph16()).xyxy();
+		GSVector8i p01 = xyzf01.upl16().blend16<0xf0>(xyzf01.yyyy().uph32(xyzf01));
 
-					tmin = tmin.min(st0.min(st1));
-					tmax = tmax.max(st0.max(st1));
-				}
-			}
+		mm.pmin = mm.pmin.min_u32(GSVector8i(p2.m)).min_u32(p01);
+		mm.pmax = mm.pmax.max_u32(GSVector8i(p2.m)).max_u32(p01);
 
-			GSVector4i xyzf0(v[index[i + 0]].m[1]);
-			GSVector4i xyzf1(v[index[i + 1]].m[1]);
+		#else
 
-			GSVector4i xy0 = xyzf0.upl16();
-			GSVector4i z0 = xyzf0.yyyy();
-			GSVector4i xy1 = xyzf1.upl16();
-			GSVector4i z1 = xyzf1.yyyy();
+		GSVector4i xyzf0(v[index[0]].m[1]);
+		GSVector4i xyzf1(v[index[1]].m[1]);
 
-			#if _M_SSE >= 0x401
+		GSVector4i xy0 = xyzf0.upl16();
+		GSVector4i z0 = xyzf0.yyyy();
+		GSVector4i xy1 = xyzf1.upl16();
+		GSVector4i z1 = xyzf1.yyyy();
 
-			GSVector4i p0 = xy0.blend16<0xf0>(z0.uph32(xyzf1));
-			GSVector4i p1 = xy1.blend16<0xf0>(z1.uph32(xyzf1));
+		#if _M_SSE >= 0x401
 
-			pmin = pmin.min_u32(p0.min_u32(p1));
-			pmax = pmax.max_u32(p0.max_u32(p1));
+		GSVector4i p0 = xy0.blend16<0xf0>(z0.uph32(xyzf0));
+		GSVector4i p1 = xy1.blend16<0xf0>(z1.uph32(xyzf1));
+		GSVector4i p2 = xy2.blend16<0xf0>(z2.uph32(xyzf2));
 
-			#else
+		mm.pmin = mm.pmin.min_u32(p2).min_u32(p0.min_u32(p1));
+		mm.pmax = mm.pmax.max_u32(p2).max_u32(p0.max_u32(p1));
 
-			GSVector4 p0 = GSVector4(xy0.upl64(z0.srl32(1).upl32(xyzf1.wwww())));
-			GSVector4 p1 = GSVector4(xy1.upl64(z1.srl32(1).upl32(xyzf1.wwww())));
+		#else
 
-			pmin = pmin.min(p0.min(p1));
-			pmax = pmax.max(p0.max(p1));
+		GSVector4 p0 = GSVector4(xy0.upl64(z0.srl32(1).upl32(xyzf0.wwww())));
+		GSVector4 p1 = GSVector4(xy1.upl64(z1.srl32(1).upl32(xyzf1.wwww())));
+		GSVector4 p2 = GSVector4(xy2.upl64(z2.srl32(1).upl32(xyzf2.wwww())));
 
-			#endif
-		}
+		mm.pmin = mm.pmin.min(p2).min(p0.min(p1));
+		mm.pmax = mm.pmax.max(p2).max(p0.max(p1));
+
+		#endif
+
+		#endif
+	}
+}
+
+template<GS_PRIM_CLASS primclass, uint32 iip, uint32 tme, uint32 fst, uint32 color>
+void GSVertexTrace::FindMinMax(const void* vertex, const uint32* index, int count)
+{
+	int n = 1;
+
+	switch(primclass)
+	{
+	case GS_POINT_CLASS:
+		n = 1;
+		break;
+	case GS_LINE_CLASS:
+	case GS_SPRITE_CLASS:
+		n = 2;
+		break;
+	case GS_TRIANGLE_CLASS:
+		n = 3;
+		break;
+	}
+
+	MinMax mm;
+
+	ResetMinMax(mm);
+
+	const GSVertex* RESTRICT v = (GSVertex*)vertex;
+
+	for(int i = 0; i < count; i += n)
+	{
+		AddPrim<primclass, iip, tme, fst, color>(mm, v, &index[i]);
 	}
 
+	UpdateMinMax(mm, tme, fst, color);
+}
+
+template<GS_PRIM_CLASS primclass, uint32 iip, uint32 tme, uint32 fst>
+void GSVertexTrace::KickPrim(const GSVertex* RESTRICT vertex, const uint32* RESTRICT index)
+{
+	AddPrim<primclass, iip, tme, fst, 1>(m_kmm, vertex, index);
+}
+
+void GSVertexTrace::UpdateMinMax(const MinMax& mm, uint32 tme, uint32 fst, uint32 color)
+{
+	const GSDrawingContext* context = m_state->m_context;
+
+	#if _M_SSE >= 0x501
+
+	GSVector4i cmin = mm.cmin.extract<0>().min_u8(mm.cmin.extract<1>());
+	GSVector4i cmax = mm.cmax.extract<0>().max_u8(mm.cmax.extract<1>());
+	GSVector4i pmin = mm.pmin.extract<0>().min_u32(mm.pmin.extract<1>());
+	GSVector4i pmax = mm.pmax.extract<0>().max_u32(mm.pmax.extract<1>());
+
+	#else
+
+	GSVector4i cmin = mm.cmin;
+	GSVector4i cmax = mm.cmax;
+
+	#if _M_SSE >= 0x401
+
+	GSVector4i pmin = mm.pmin;
+	GSVector4i pmax = mm.pmax;
+
+	#else
+
+	GSVector4 pmin = mm.pmin;
+	GSVector4 pmax = mm.pmax;
+
+	#endif
+
+	#endif
+
 	#if _M_SSE >= 0x401
 
 	pmin = pmin.blend16<0x30>(pmin.srl32(1));
@@ -462,8 +606,8 @@ void GSVertexTrace::FindMinMax(const void* vertex, const uint32* index, int coun
 			s = GSVector4(1 << context->TEX0.TW, 1 << context->TEX0.TH, 1, 1);
 		}
 
-		m_min.t = tmin * s;
-		m_max.t = tmax * s;
+		m_min.t = mm.tmin * s;
+		m_max.t = mm.tmax * s;
 	}
 	else
 	{
@@ -40,13 +40,53 @@ protected:
 
 	static const GSVector4 s_minmax;
 
+	// raw min/max of the vertex fields, converted to m_min/m_max by UpdateMinMax
+
+	__aligned(struct, 32) MinMax
+	{
+		GSVector4 tmin, tmax;
+
+		#if _M_SSE >= 0x501
+
+		GSVector8i cmin, cmax; // two vertices per register, folded in UpdateMinMax
+		GSVector8i pmin, pmax;
+
+		#elif _M_SSE >= 0x401
+
+		GSVector4i cmin, cmax;
+		GSVector4i pmin, pmax;
+
+		#else
+
+		GSVector4i cmin, cmax;
+		GSVector4 pmin, pmax;
+
+		#endif
+	};
+
+	MinMax m_kmm; // accumulated by Kick while the vertices are queued
+
 	typedef void (GSVertexTrace::*FindMinMaxPtr)(const void* vertex, const uint32* index, int count);
+	typedef void (GSVertexTrace::*KickPtr)(const GSVertex* RESTRICT vertex, const uint32* RESTRICT index);
 
 	FindMinMaxPtr m_fmm[2][2][2][2][4];
+	KickPtr m_fk[2][2][2][4];
+	KickPtr m_kick;
+
+	static void ResetMinMax(MinMax& mm);
+
+	template<GS_PRIM_CLASS primclass, uint32 iip, uint32 tme, uint32 fst, uint32 color>
+	static void AddPrim(MinMax& mm, const GSVertex* RESTRICT v, const uint32* RESTRICT index);
 
 	template<GS_PRIM_CLASS primclass, uint32 iip, uint32 tme, uint32 fst, uint32 color>
 	void FindMinMax(const void* vertex, const uint32* index, int count);
 
+	template<GS_PRIM_CLASS primclass, uint32 iip, uint32 tme, uint32 fst>
+	void KickPrim(const GSVertex* RESTRICT vertex, const uint32* RESTRICT index);
+
+	void UpdateMinMax(const MinMax& mm, uint32 tme, uint32 fst, uint32 color);
+	void UpdateFilter();
+
 public:
 	GS_PRIM_CLASS m_primclass;
 
@@ -74,5 +114,14 @@ public:
 
 	void Update(const void* vertex, const uint32* index, int count, GS_PRIM_CLASS primclass);
 
+	// incremental trace, the owner calls Kick for every primitive it appends to the index buffer,
+	// UpdateKick whenever PRIM changes, and ResetKick when the index buffer is emptied
+
+	void Update(GS_PRIM_CLASS primclass);
+	void UpdateKick();
+	void ResetKick() {ResetMinMax(m_kmm);}
+
+	__forceinline void Kick(const GSVertex* RESTRICT vertex, const uint32* RESTRICT index) {(this->*m_kick)(vertex, index);}
+
 	bool IsLinear() const {return m_filter.linear;}
 };
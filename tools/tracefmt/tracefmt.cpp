@@ -0,0 +1,294 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2010  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// --------------------------------------------------------------------------------------
+//  tracefmt - converts a binary trace (emuLog.trace) back into emuLog text
+// --------------------------------------------------------------------------------------
+// Usage: tracefmt emuLog.trace [output.txt]
+//
+// The output matches what PCSX2 writes to emuLog.txt with binary tracing disabled, so
+// existing log diffing scripts keep working.
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined (__linux__) && !defined(__LINUX__)  // some distributions are lower case
+#define __LINUX__
+#endif
+
+#include "Pcsx2Types.h"
+#include "../../pcsx2/DebugTools/BinaryTraceFormat.h"
+
+struct TraceSource
+{
+	std::string	name;
+	std::string	suffix;
+	bool		prefix;
+};
+
+static std::vector<std::string>	formats;
+static std::vector<TraceSource>	sources;
+static int						longsize = sizeof(long);
+
+template< typename T >
+static void setDefinition( std::vector<T>& list, u32 id, const T& value )
+{
+	if( id >= list.size() ) list.resize( id + 1 );
+	list[id] = value;
+}
+
+// Appends literal format text, collapsing "%%" the way printf would.
+static void appendLiteral( std::string& out, const char* begin, const char* end )
+{
+	for( const char* p = begin; p < end; ++p )
+	{
+		out += *p;
+		if( p[0] == '%' && p+1 < end && p[1] == '%' ) ++p;
+	}
+}
+
+// Rebuilds a single conversion spec for this host's printf: '*' widths are replaced with
+// the recorded values and integer length modifiers are normalized to match 'size'.
+static std::string buildSpec( const BinaryTraceArg& arg, const s32* stars, int size )
+{
+	std::string spec;
+	int star = 0;
+
+	for( int i=0; i<arg.speclen-1; ++i )
+	{
+		char c = arg.spec[i];
+		if( c == '*' )
+		{
+			char buf[16];
+			sprintf( buf, "%d", stars[star++] );
+			spec += buf;
+		}
+		else if( strchr( "hlLqjzt", c ) )
+			continue;
+		else if( c == 'I' && arg.spec[i+1] == '6' && arg.spec[i+2] == '4' )
+			i += 2;
+		else
+			spec += c;
+	}
+
+	if( size == 8 ) spec += "ll";
+	spec += arg.spec[arg.speclen-1];
+	return spec;
+}
+
+static void formatRecord( std::string& out, const char* fmt, const u8* payload, uint length, bool truncated )
+{
+	const u8* pos = payload;
+	const u8* const end = payload + length;
+
+	BinaryTraceArg arg;
+	const char* next;
+	char buf[512];
+
+	while( (next = BinaryTrace_ParseFormat( fmt, arg, longsize )) != NULL )
+	{
+		appendLiteral( out, fmt, arg.spec );
+		fmt = next;
+
+		s32 stars[2] = { 0, 0 };
+		for( int i=0; i<arg.stars; ++i, pos += 4 )
+		{
+			if( pos + 4 > end ) goto truncate;
+			if( i < 2 ) memcpy( &stars[i], pos, 4 );
+		}
+
+		switch( arg.type )
+		{
+			case BTA_Int:
+				if( pos + arg.size > end ) goto truncate;
+				if( arg.size == 4 )
+				{
+					u32 value;
+					memcpy( &value, pos, 4 );
+					snprintf( buf, sizeof(buf), buildSpec( arg, stars, 4 ).c_str(), value );
+				}
+				else
+				{
+					u64 value;
+					memcpy( &value, pos, 8 );
+					snprintf( buf, sizeof(buf), buildSpec( arg, stars, 8 ).c_str(), (unsigned long long)value );
+				}
+				pos += arg.size;
+			break;
+
+			case BTA_Double:
+			{
+				if( pos + 8 > end ) goto truncate;
+				double value;
+				memcpy( &value, pos, 8 );
+				snprintf( buf, sizeof(buf), buildSpec( arg, stars, 0 ).c_str(), value );
+				pos += 8;
+			}
+			break;
+
+			case BTA_Pointer:
+			{
+				if( pos + 8 > end ) goto truncate;
+				u64 value;
+				memcpy( &value, pos, 8 );
+				snprintf( buf, sizeof(buf), "0x%llx", (unsigned long long)value );
+				pos += 8;
+			}
+			break;
+
+			case BTA_String:
+			{
+				const u8* nul = (const u8*)memchr( pos, 0, end - pos );
+				if( !nul ) goto truncate;
+				snprintf( buf, sizeof(buf), buildSpec( arg, stars, 0 ).c_str(), (const char*)pos );
+				pos = nul + 1;
+
+				// A cut-off string is the last thing in a truncated record.
+				if( truncated && pos == end ) { out += buf; goto truncate; }
+			}
+			break;
+		}
+
+		out += buf;
+	}
+
+	appendLiteral( out, fmt, fmt + strlen(fmt) );
+	if( !truncated ) return;
+
+truncate:
+	out += " [...]";
+}
+
+static bool readText( FILE* in, std::string& text, uint length )
+{
+	text.resize( length );
+	return !length || fread( &text[0], length, 1, in ) == 1;
+}
+
+int main( int argc, char* argv[] )
+{
+	if( argc < 2 )
+	{
+		fprintf( stderr, "Usage: tracefmt emuLog.trace [output.txt]\n" );
+		return 1;
+	}
+
+	FILE* in = fopen( argv[1], "rb" );
+	if( !in )
+	{
+		fprintf( stderr, "tracefmt: can't open %s\n", argv[1] );
+		return 1;
+	}
+
+	FILE* out = (argc > 2) ? fopen( argv[2], "w" ) : stdout;
+	if( !out )
+	{
+		fprintf( stderr, "tracefmt: can't create %s\n", argv[2] );
+		return 1;
+	}
+
+	BinaryTraceFileHeader header;
+	if( fread( &header, sizeof(header), 1, in ) != 1 || header.magic != BinaryTrace_Magic )
+	{
+		fprintf( stderr, "tracefmt: %s is not a PCSX2 binary trace\n", argv[1] );
+		return 1;
+	}
+
+	if( header.version < 1 || header.version > BinaryTrace_Version )
+	{
+		fprintf( stderr, "tracefmt: unsupported trace version %u\n", header.version );
+		return 1;
+	}
+
+	longsize = header.longsize;
+
+	BinaryTraceEntry entry;
+	std::string text;
+	std::string line;
+	u8 payload[BinaryTrace_MaxPayloadSize];
+
+	while( fread( &entry, sizeof(entry), 1, in ) == 1 )
+	{
+		switch( entry.tag )
+		{
+			case BTT_Format:
+				if( !readText( in, text, entry.length ) ) goto eof;
+				setDefinition( formats, entry.format, text );
+			break;
+
+			case BTT_Source:
+			{
+				if( !readText( in, text, entry.length ) ) goto eof;
+
+				TraceSource source;
+				source.name		= text.c_str();
+				source.suffix	= (source.name.size() < text.size()) ? text.substr( source.name.size() + 1 ) : "";
+				source.prefix	= (entry.flags & BTF_HasPrefix) != 0;
+				setDefinition( sources, entry.source, source );
+			}
+			break;
+
+			case BTT_Dropped:
+				fprintf( out, "*** %u trace records dropped ***\n", entry.flags );
+			break;
+
+			case BTT_Record:
+			{
+				// Reassemble arguments that spilled past the entry.
+				if( entry.length > BinaryTrace_MaxPayloadSize - BinaryTrace_PayloadSize )
+				{
+					fprintf( stderr, "tracefmt: record payload too large, file is corrupt\n" );
+					goto eof;
+				}
+
+				memcpy( payload, entry.payload, BinaryTrace_PayloadSize );
+				if( entry.length && fread( payload + BinaryTrace_PayloadSize, entry.length, 1, in ) != 1 ) goto eof;
+
+				if( entry.format >= formats.size() || entry.source >= sources.size() )
+				{
+					fprintf( stderr, "tracefmt: record references an undefined format or source\n" );
+					break;
+				}
+
+				const TraceSource& source = sources[entry.source];
+				line.clear();
+
+				if( source.prefix )
+				{
+					char buf[64];
+					snprintf( buf, sizeof(buf), "%-4s(%8.8x %8.8x): ", source.name.c_str(), entry.pc, entry.cycle );
+					line = buf;
+					line += source.suffix;
+				}
+
+				formatRecord( line, formats[entry.format].c_str(), payload, BinaryTrace_PayloadSize + entry.length, (entry.flags & BTF_Truncated) != 0 );
+				fputs( line.c_str(), out );
+				fputc( '\n', out );
+			}
+			break;
+
+			default:
+				fprintf( stderr, "tracefmt: unknown entry type %u, file is corrupt\n", entry.tag );
+				goto eof;
+		}
+	}
+
+eof:
+	fclose( in );
+	if( out != stdout ) fclose( out );
+	return 0;
+}